@@ -0,0 +1,78 @@
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <vector>
+#include <opencv2/opencv.hpp>
+#include "../headers/engine_factory.h"
+#include "../headers/frame_queue.h"
+#include "../headers/reorder_buffer.h"
+#include "../headers/metrics.h"
+#include "../headers/nms.h"
+
+using namespace std;
+
+extern void consumer(FrameQueue& fq, InferEngine& engine, ReorderBuffer& out, Metrics& metrics,
+                     atomic<bool>& running, const PostprocessConfig& post);
+extern void asyncConsumer(FrameQueue& fq, InferEngine& engine, ReorderBuffer& out, Metrics& metrics,
+                          atomic<bool>& running, const PostprocessConfig& post,
+                          size_t in_flight);
+
+// One worker running the full pipeline on `n` synthetic 1280x720 frames with up to
+// `in_flight` frames inside the engine; 1 is the blocking consumer(). Frames are queued
+// up front, so the numbers show how far overlapping pre/postprocess with inference
+// lifts throughput, not source pacing.
+static double run(InferEngine& engine, size_t in_flight, int n, bool& executor) {
+    cv::Mat frame(720, 1280, CV_8UC3);
+    cv::randu(frame, 0, 255);
+
+    FrameQueue fq(static_cast<size_t>(n));
+    size_t written = 0;
+    ReorderBuffer ordered([&](const cv::Mat&) { written++; });
+    atomic<bool> running{true};
+    Metrics metrics;
+    for (int i = 0; i < n; ++i) fq.push(frame.clone());
+    running = false;
+    fq.close();
+
+    ostringstream sink;
+    auto* cerr_buf = cerr.rdbuf(sink.rdbuf());
+    auto start = chrono::steady_clock::now();
+    if (in_flight == 1) {
+        consumer(fq, engine, ordered, metrics, running, PostprocessConfig{0.25f, 0.6f});
+    } else {
+        asyncConsumer(fq, engine, ordered, metrics, running, PostprocessConfig{0.25f, 0.6f}, in_flight);
+    }
+    double secs = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cerr.rdbuf(cerr_buf);
+
+    executor = engine.asyncUsesExecutor();
+    if (written != static_cast<size_t>(n)) {
+        cerr << "warning: " << written << " of " << n << " frames written\n";
+    }
+    return n / secs;
+}
+
+int main(int argc, char** argv) {
+    const string model_path = (argc > 1) ? argv[1] : "yolov8n.onnx";
+    const int n = (argc > 2) ? stoi(argv[2]) : 200;
+
+    EngineFactory factory;
+    auto engine = factory.create(model_path);
+
+    cout << "Single-worker throughput, " << n << " frames, model " << model_path
+         << " (" << thread::hardware_concurrency() << " hardware threads)\n";
+    cout << left << setw(12) << "in flight" << setw(12) << "frames/s" << "runs on\n";
+    double base = 0.0;
+    for (size_t k : {1, 2, 3, 4}) {
+        bool executor = false;
+        const double fps = run(*engine, k, n, executor);
+        if (k == 1) base = fps;
+        cout << left << setw(12) << k << setw(12) << fixed << setprecision(1) << fps
+             << (k == 1 ? "blocking infer()" : executor ? "executor thread" : "RunAsync")
+             << "  " << setprecision(2) << fps / base << "x\n";
+    }
+    return 0;
+}
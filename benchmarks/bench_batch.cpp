@@ -0,0 +1,49 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <fstream>
+#include <vector>
+#include <opencv2/opencv.hpp>
+#include "../headers/infer_engine.h"
+#include "../headers/preprocess.h"
+
+using namespace std;
+
+// Inference throughput against batch size. Frames are preprocessed once up front and
+// copied into the batch buffer each round, so the numbers cover the engine alone.
+int main(int argc, char** argv) {
+    const string model_path = (argc > 1) ? argv[1] : "yolov8n_dyn.onnx";
+    const int frames_per_size = (argc > 2) ? stoi(argv[2]) : 64;
+    if (!ifstream(model_path).good()) {
+        cerr << "Model not found: " << model_path << "\n";
+        return 1;
+    }
+
+    InferEngine engine(model_path);
+    Preprocessor pre(engine.getInputWidth(), engine.getInputHeight());
+    cout << "Model " << model_path << " (" << engine.getInputWidth() << "x" << engine.getInputHeight() << ")"
+         << (engine.supportsBatch() ? ", dynamic batch" : ", fixed batch 1: frames run one at a time") << "\n";
+
+    const size_t sizes[] = {1, 2, 4, 8};
+    vector<cv::Mat> blobs;
+    for (size_t i = 0; i < sizes[3]; ++i) {
+        cv::Mat frame(720, 1280, CV_8UC3);
+        cv::randu(frame, 0, 255);
+        blobs.push_back(pre.process(frame).clone());
+    }
+
+    cout << left << setw(8) << "batch" << setw(14) << "ms/batch" << setw(14) << "ms/frame" << "frames/s\n";
+    for (size_t n : sizes) {
+        vector<cv::Mat> batch(blobs.begin(), blobs.begin() + n);
+        engine.inferBatch(batch);  //warm up, binds this batch size
+
+        const int rounds = max<int>(1, frames_per_size / static_cast<int>(n));
+        auto start = chrono::steady_clock::now();
+        for (int r = 0; r < rounds; ++r) engine.inferBatch(batch);
+        const double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count() / rounds;
+
+        cout << left << setw(8) << n << setw(14) << fixed << setprecision(2) << ms
+             << setw(14) << ms / n << setprecision(1) << 1000.0 * n / ms << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,46 @@
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <chrono>
+#include <vector>
+#include <opencv2/opencv.hpp>
+#include "../headers/frame_queue.h"
+
+using namespace std;
+
+// Hands `n` small frames from one producer thread to one consumer thread and
+// returns the mean handoff cost in nanoseconds per frame.
+static double run_handoff(QueueMode mode, size_t capacity, int n) {
+    FrameQueue fq(capacity, mode);
+    cv::Mat frame(64, 64, CV_8UC3, cv::Scalar(1, 2, 3));
+
+    auto start = chrono::steady_clock::now();
+    thread consumer([&] {
+        cv::Mat out;
+        while (fq.pop(out)) {}
+    });
+    for (int i = 0; i < n; ++i) {
+        fq.push(frame);
+    }
+    fq.close();
+    consumer.join();
+    auto ns = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+    return static_cast<double>(ns) / n;
+}
+
+int main(int argc, char** argv) {
+    const int n = (argc > 1) ? stoi(argv[1]) : 200000;
+    const size_t capacities[] = {1, 4, 24};
+
+    cout << "FrameQueue handoff, " << n << " frames of 64x64 CV_8UC3\n";
+    cout << left << setw(10) << "capacity" << setw(16) << "mutex ns/frame" << setw(16) << "spsc ns/frame" << "speedup\n";
+    for (size_t cap : capacities) {
+        double mutex_ns = run_handoff(QueueMode::Mutex, cap, n);
+        double spsc_ns = run_handoff(QueueMode::Spsc, cap, n);
+        cout << left << setw(10) << cap
+             << setw(16) << fixed << setprecision(1) << mutex_ns
+             << setw(16) << spsc_ns
+             << setprecision(2) << mutex_ns / spsc_ns << "x\n";
+    }
+    return 0;
+}
@@ -0,0 +1,108 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <cstdio>
+#include <unistd.h>
+#include <opencv2/opencv.hpp>
+#include "../headers/infer_engine.h"
+#include "../headers/preprocess.h"
+
+using namespace std;
+namespace fs = std::filesystem;
+
+// Load time and memory of one process, loading the model from its path or from a
+// read-only mapping, for the ONNX export and for its ORT format optimized-model cache
+// entry. Memory is split into private pages (counted once per worker process) and
+// file-backed shared pages (counted once per host). Each mode runs in a fresh child
+// process so nothing stays mapped or pooled from an earlier one.
+// Linux only: memory is read from /proc/self/statm.
+
+static void memory_mb(double& private_mb, double& shared_mb) {
+    ifstream statm("/proc/self/statm");
+    long pages = 0, resident = 0, shared = 0;
+    statm >> pages >> resident >> shared;
+    const double page_mb = sysconf(_SC_PAGESIZE) / (1024.0 * 1024.0);
+    private_mb = (resident - shared) * page_mb;
+    shared_mb = shared * page_mb;
+}
+
+static int child(const string& model_path, bool mmap_model, const string& cache_dir) {
+    SessionConfig config;
+    config.mmap_model = mmap_model;
+    config.optimized_model_dir = cache_dir;
+
+    double private_before = 0, shared_before = 0;
+    memory_mb(private_before, shared_before);
+    auto start = chrono::steady_clock::now();
+    InferEngine engine(model_path, config);
+    const double load_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    //one run, so lazily created kernels and buffers are counted too
+    cv::Mat frame(720, 1280, CV_8UC3);
+    cv::randu(frame, 0, 255);
+    Preprocessor pre(engine.getInputWidth(), engine.getInputHeight());
+    pre.processInto(frame, engine.inputData());
+    engine.infer();
+
+    double private_after = 0, shared_after = 0;
+    memory_mb(private_after, shared_after);
+    cout << fixed << setprecision(1) << load_ms << " " << private_after - private_before << " "
+         << shared_after - shared_before << " " << engine.loadedFromCache() << endl;
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc == 5 && string(argv[1]) == "--child") {
+        return child(argv[2], string(argv[3]) == "1", argv[4] == string("-") ? "" : argv[4]);
+    }
+
+    const string model_path = (argc > 1) ? argv[1] : "yolov8n.onnx";
+    const int rounds = (argc > 2) ? stoi(argv[2]) : 3;
+    if (!ifstream(model_path).good()) {
+        cerr << "Model not found: " << model_path << "\n";
+        return 1;
+    }
+    const fs::path cache_dir = fs::temp_directory_path() / "bench_modelload_cache";
+    fs::remove_all(cache_dir);
+
+    auto measure = [&](bool mmap_model, const string& cache) {
+        const string cmd = string(argv[0]) + " --child " + model_path + " " + (mmap_model ? "1" : "0") + " " +
+                           (cache.empty() ? "-" : cache) + " 2>/dev/null";
+        string out;
+        if (FILE* p = popen(cmd.c_str(), "r")) {
+            char buf[128];
+            while (fgets(buf, sizeof(buf), p)) out = buf;  //last line holds the figures
+            pclose(p);
+        }
+        return out;
+    };
+
+    //fill the cache once, so the ORT format rows load from it
+    measure(false, cache_dir.string());
+
+    cout << "Loading " << model_path << ", best of " << rounds << " fresh processes\n";
+    cout << left << setw(16) << "source" << setw(8) << "load" << setw(12) << "load ms" << setw(14) << "private MB"
+         << "shared MB\n";
+    struct Mode { const char* source; bool mmap_model; string cache; };
+    const Mode modes[] = {{"onnx", false, ""}, {"onnx", true, ""},
+                          {"ort (cache)", false, cache_dir.string()}, {"ort (cache)", true, cache_dir.string()}};
+    for (const auto& mode : modes) {
+        double best_ms = 1e30, private_mb = 0, shared_mb = 0;
+        bool from_cache = false;
+        for (int r = 0; r < rounds; ++r) {
+            istringstream fields(measure(mode.mmap_model, mode.cache));
+            double ms = 0, priv = 0, shared = 0;
+            if (!(fields >> ms >> priv >> shared >> from_cache)) continue;
+            if (ms < best_ms) { best_ms = ms; private_mb = priv; shared_mb = shared; }
+        }
+        cout << left << setw(16) << mode.source << setw(8) << (mode.mmap_model ? "mmap" : "path")
+             << setw(12) << fixed << setprecision(1) << best_ms << setw(14) << private_mb << shared_mb
+             << (mode.cache.empty() || from_cache ? "" : "  (cache not used)") << "\n";
+    }
+    fs::remove_all(cache_dir);
+    return 0;
+}
@@ -0,0 +1,65 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <vector>
+#include <opencv2/opencv.hpp>
+#include "../headers/nms.h"
+
+using namespace std;
+
+// All-pairs applyNMS against the grid-bucketed GridNms on crowded candidate sets of
+// 1k-8k boxes, the sizes a low --conf threshold feeds NMS on a busy 1280x720 scene.
+// Candidates are clusters of jittered boxes around random objects, in one class (the
+// worst case for class-aware NMS) and spread over 4 vehicle classes.
+
+static vector<Detection> crowded(int n, int classes, unsigned seed) {
+    cv::RNG rng(seed);
+    vector<Detection> dets;
+    while (static_cast<int>(dets.size()) < n) {
+        const float cx = rng.uniform(0.0f, 1280.0f), cy = rng.uniform(0.0f, 720.0f);
+        const float w = rng.uniform(10.0f, 200.0f), h = rng.uniform(10.0f, 150.0f);
+        const int cls = rng.uniform(0, classes);
+        for (int k = 0; k < 20 && static_cast<int>(dets.size()) < n; ++k) {
+            const float jx = rng.uniform(-0.3f, 0.3f) * w, jy = rng.uniform(-0.3f, 0.3f) * h;
+            dets.push_back({cv::Rect2f(cx + jx - w / 2, cy + jy - h / 2, w, h), rng.uniform(0.05f, 1.0f), cls});
+        }
+    }
+    return dets;
+}
+
+template <typename Fn>
+static double time_us(const vector<Detection>& input, Fn fn, int iters, size_t& kept) {
+    vector<Detection> dets;
+    double total = 0;
+    for (int i = 0; i <= iters; ++i) {
+        dets = input;
+        auto start = chrono::steady_clock::now();
+        fn(dets);
+        if (i > 0) total += chrono::duration<double, micro>(chrono::steady_clock::now() - start).count();  //first is warm-up
+    }
+    kept = dets.size();
+    return total / iters;
+}
+
+int main(int argc, char** argv) {
+    const int iters = (argc > 1) ? stoi(argv[1]) : 20;
+    const float iou = 0.45f;
+
+    cout << "Class-aware NMS at IoU " << iou << ", mean of " << iters << " runs (us)\n";
+    cout << left << setw(12) << "candidates" << setw(10) << "classes" << setw(8) << "kept" << setw(14) << "all pairs"
+         << setw(12) << "grid" << "speedup\n";
+    GridNms grid;
+    for (int n : {1000, 2000, 4000, 8000}) {
+        for (int classes : {1, 4}) {
+            const vector<Detection> input = crowded(n, classes, n);
+            size_t kept_pairs = 0, kept_grid = 0;
+            const double pairs_us = time_us(input, [&](vector<Detection>& d) { applyNMS(d, iou); }, iters, kept_pairs);
+            const double grid_us = time_us(input, [&](vector<Detection>& d) { grid.apply(d, iou); }, iters, kept_grid);
+            cout << left << setw(12) << n << setw(10) << classes << setw(8) << kept_grid << fixed << setprecision(1)
+                 << setw(14) << pairs_us << setw(12) << grid_us << pairs_us / grid_us << "x"
+                 << (kept_pairs == kept_grid ? "" : "  (MISMATCH)") << "\n";
+            cout.unsetf(ios::fixed);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,102 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <fstream>
+#include <vector>
+#include <opencv2/opencv.hpp>
+#include "../headers/infer_engine.h"
+#include "../headers/preprocess.h"
+#include "../headers/decoder.h"
+#include "../headers/nms.h"
+
+using namespace std;
+
+// Decoding real model output: the row decoder postprocess used before, which needed the
+// [84, 8400] head transposed first (twice over, by the consumer and by postprocess),
+// against the channel-major decoder with its scalar and AVX2 kernels. The head comes
+// from running the model on an image (argument 2), or on a synthetic street-like frame.
+// Full postprocess runs with the default top-K/max-det caps and without them. The
+// "vehicles" column decodes only the COCO car, motorcycle, bus and truck planes; "4-class"
+// decodes the same four planes cut out into an [8, N] head, as a vehicle-only model emits.
+
+// The transpose plus per-row class scan the decoder replaces.
+static void transpose_and_scan(const cv::Mat& head, const LetterboxMap& map, float conf, vector<Detection>& out) {
+    cv::Mat rows = head.t();
+    YoloDecoder().decode(rows, map, conf, out);
+}
+
+template <typename Fn>
+static double time_us(Fn fn, int iters) {
+    fn();  //warm up
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < iters; ++i) fn();
+    return chrono::duration<double, micro>(chrono::steady_clock::now() - start).count() / iters;
+}
+
+int main(int argc, char** argv) {
+    const string model_path = (argc > 1) ? argv[1] : "yolov8n.onnx";
+    const string image_path = (argc > 2) ? argv[2] : "";
+    const int iters = (argc > 3) ? stoi(argv[3]) : 500;
+    if (!ifstream(model_path).good()) {
+        cerr << "Model not found: " << model_path << "\n";
+        return 1;
+    }
+
+    cv::Mat frame;
+    if (!image_path.empty()) frame = cv::imread(image_path);
+    if (frame.empty()) {
+        //gray road with a few car-sized blocks, so some anchors score above background
+        frame = cv::Mat(720, 1280, CV_8UC3, cv::Scalar(90, 90, 90));
+        cv::RNG rng(1);
+        for (int i = 0; i < 12; ++i) {
+            cv::Rect car(rng.uniform(0, 1150), rng.uniform(200, 650), rng.uniform(60, 130), rng.uniform(40, 70));
+            cv::rectangle(frame, car, cv::Scalar(rng.uniform(0, 255), rng.uniform(0, 255), rng.uniform(0, 255)), cv::FILLED);
+        }
+    }
+
+    InferEngine engine(model_path);
+    Preprocessor pre(engine.getInputWidth(), engine.getInputHeight());
+    pre.processInto(frame, engine.inputData());
+    const cv::Mat head = engine.infer().clone();
+    const auto [scale, padding] = pre.getScaleAndPadding();
+    const LetterboxMap map{scale, static_cast<float>(padding.x), static_cast<float>(padding.y), frame.size()};
+
+    const HeadLayout& layout = engine.head();
+    YoloDecoder scalar(layout), simd(layout), vehicles(layout);
+    scalar.useSimd(false);
+    vehicles.setClasses({2, 3, 5, 7});
+
+    //box rows plus the four vehicle planes, as a 4-class model's head
+    cv::Mat small_head = head.rowRange(0, 4).clone();
+    for (int c : {2, 3, 5, 7}) small_head.push_back(head.row(4 + c));
+    HeadLayout small_layout = layout;
+    small_layout.num_classes = 4;
+    YoloDecoder small(small_layout);
+    vector<Detection> dets;
+    dets.reserve(head.cols);
+
+    cout << "Decoding a [" << head.rows << ", " << head.cols << "] head, mean of " << iters << " runs (us)"
+         << (YoloDecoder::simdAvailable() ? "" : "; AVX2 not available, SIMD runs scalar") << "\n";
+    cout << left << setw(8) << "conf" << setw(12) << "candidates" << setw(16) << "transpose+rows"
+         << setw(10) << "scalar" << setw(10) << "AVX2" << setw(10) << "vehicles" << setw(10) << "4-class" << setw(10) << "capped" << "uncapped\n";
+    for (float conf : {0.5f, 0.25f, 0.05f, 0.001f}) {
+        dets.clear();
+        simd.decode(head, map, conf, dets);
+        const size_t candidates = dets.size();
+
+        const double rows_us = time_us([&] { dets.clear(); transpose_and_scan(head, map, conf, dets); }, iters);
+        const double scalar_us = time_us([&] { dets.clear(); scalar.decode(head, map, conf, dets); }, iters);
+        const double simd_us = time_us([&] { dets.clear(); simd.decode(head, map, conf, dets); }, iters);
+        const double vehicles_us = time_us([&] { dets.clear(); vehicles.decode(head, map, conf, dets); }, iters);
+        const double small_us = time_us([&] { dets.clear(); small.decode(small_head, map, conf, dets); }, iters);
+        PostprocessConfig capped{conf, 0.45f};
+        PostprocessConfig uncapped{conf, 0.45f, 0, 0};
+        const double capped_us = time_us([&] { postprocess(head, frame.size(), scale, padding, capped); }, iters);
+        const double uncapped_us = time_us([&] { postprocess(head, frame.size(), scale, padding, uncapped); }, iters);
+        cout << left << setw(8) << conf << setw(12) << candidates << fixed << setprecision(1) << setw(16) << rows_us
+             << setw(10) << scalar_us << setw(10) << simd_us << setw(10) << vehicles_us << setw(10) << small_us
+             << setw(10) << capped_us << uncapped_us << "\n";
+        cout.unsetf(ios::fixed);
+    }
+    return 0;
+}
@@ -0,0 +1,74 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstring>
+#include <vector>
+#include <opencv2/opencv.hpp>
+#include "../headers/preprocess.h"
+
+using namespace std;
+
+// The multi-pass pipeline Preprocessor::process used before the fused kernel:
+// resize, copy into a gray canvas, cvtColor, convertTo, split and three memcpys.
+static cv::Mat multi_pass(const cv::Mat& frame, int input_w, int input_h) {
+    float scale = min(static_cast<float>(input_w) / frame.cols, static_cast<float>(input_h) / frame.rows);
+    int new_w = static_cast<int>(frame.cols * scale);
+    int new_h = static_cast<int>(frame.rows * scale);
+
+    cv::Mat resized;
+    cv::resize(frame, resized, cv::Size(new_w, new_h));
+    cv::Mat letterboxed(input_h, input_w, frame.type(), cv::Scalar(114, 114, 114));
+    resized.copyTo(letterboxed(cv::Rect((input_w - new_w) / 2, (input_h - new_h) / 2, new_w, new_h)));
+
+    cv::Mat rgb, float_img;
+    cv::cvtColor(letterboxed, rgb, cv::COLOR_BGR2RGB);
+    rgb.convertTo(float_img, CV_32F, 1.0 / 255.0);
+    vector<cv::Mat> channels(3);
+    cv::split(float_img, channels);
+
+    cv::Mat blob_1d(1, 3 * input_h * input_w, CV_32F);
+    for (int c = 0; c < 3; ++c) {
+        memcpy(blob_1d.ptr<float>(0) + c * input_h * input_w, channels[c].ptr<float>(0),
+               input_h * input_w * sizeof(float));
+    }
+    return blob_1d;
+}
+
+template <typename Fn>
+static double time_us(Fn fn, int iters) {
+    fn();  //warm up
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < iters; ++i) fn();
+    return chrono::duration<double, micro>(chrono::steady_clock::now() - start).count() / iters;
+}
+
+int main(int argc, char** argv) {
+    const int iters = (argc > 1) ? stoi(argv[1]) : 200;
+    const cv::Size sizes[] = {{640, 640}, {1280, 720}, {1920, 1080}};
+
+    cout << "Preprocessing into a 640x640 blob, mean of " << iters << " frames (us/frame)\n";
+    cout << left << setw(12) << "frame" << setw(14) << "multi-pass" << setw(14) << "fused scalar"
+         << setw(14) << "fused avx2" << "speedup\n";
+    for (const auto& sz : sizes) {
+        cv::Mat frame(sz, CV_8UC3);
+        cv::randu(frame, 0, 255);
+        Preprocessor pre(640, 640);
+
+        double before = time_us([&] { multi_pass(frame, 640, 640); }, iters);
+        pre.useSimd(false);
+        double scalar = time_us([&] { pre.process(frame); }, iters);
+        double simd = scalar;
+        if (Preprocessor::simdAvailable()) {
+            pre.useSimd(true);
+            simd = time_us([&] { pre.process(frame); }, iters);
+        }
+
+        cout << left << setw(12) << (to_string(sz.width) + "x" + to_string(sz.height))
+             << setw(14) << fixed << setprecision(1) << before
+             << setw(14) << scalar;
+        if (Preprocessor::simdAvailable()) cout << setw(14) << simd;
+        else cout << setw(14) << "n/a";
+        cout << setprecision(2) << before / min(scalar, simd) << "x\n";
+    }
+    return 0;
+}
@@ -0,0 +1,140 @@
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <numeric>
+#include <vector>
+#include <unistd.h>
+#include <opencv2/opencv.hpp>
+#include "../headers/infer_engine.h"
+#include "../headers/preprocess.h"
+#include "../headers/nms.h"
+
+using namespace std;
+
+// Side-by-side FP32 vs INT8 report on the same frames: resident memory each engine adds,
+// inference latency, and how well the INT8 detections agree with the FP32 ones.
+// Agreement matches each FP32 detection to the best unmatched INT8 detection of the
+// same class with IoU >= 0.5: recall = matched FP32 boxes, precision = matched INT8
+// boxes, plus the mean IoU and confidence shift of the matches.
+//
+// usage: bench_quantized <fp32.onnx> <int8.onnx> [video] [frames]
+// Without a readable video, random frames are used; they exercise latency and memory
+// but give few detections to compare. RSS is read from /proc/self/statm (Linux).
+
+static double rss_mb() {
+    ifstream statm("/proc/self/statm");
+    long pages = 0, resident = 0;
+    statm >> pages >> resident;
+    return resident * static_cast<double>(sysconf(_SC_PAGESIZE)) / (1024.0 * 1024.0);
+}
+
+struct Run {
+    double load_mb = 0;
+    vector<double> latency_ms;
+    vector<vector<Detection>> detections;
+};
+
+static Run run_model(InferEngine& engine, const vector<cv::Mat>& frames) {
+    Run run;
+    Preprocessor pre(engine.getInputWidth(), engine.getInputHeight());
+    for (const auto& frame : frames) {
+        pre.processInto(frame, engine.inputData());
+        auto start = chrono::steady_clock::now();
+        cv::Mat preds = engine.infer();
+        run.latency_ms.push_back(chrono::duration<double, milli>(chrono::steady_clock::now() - start).count());
+        const auto [scale, padding] = pre.getScaleAndPadding();
+        run.detections.push_back(postprocess(preds, frame.size(), scale, padding, 0.25f, 0.45f));
+    }
+    return run;
+}
+
+static double percentile(vector<double> v, double q) {
+    sort(v.begin(), v.end());
+    return v.empty() ? 0.0 : v[min(v.size() - 1, static_cast<size_t>(q * v.size()))];
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        cerr << "usage: " << argv[0] << " <fp32.onnx> <int8.onnx> [video] [frames]\n";
+        return 1;
+    }
+    const string fp32_path = argv[1], int8_path = argv[2];
+    const string video = (argc > 3) ? argv[3] : "";
+    const int max_frames = (argc > 4) ? stoi(argv[4]) : 200;
+
+    vector<cv::Mat> frames;
+    if (!video.empty()) {
+        cv::VideoCapture cap(video);
+        cv::Mat frame;
+        while (static_cast<int>(frames.size()) < max_frames && cap.read(frame)) frames.push_back(frame.clone());
+    }
+    const bool synthetic = frames.empty();
+    while (static_cast<int>(frames.size()) < max_frames) {
+        cv::Mat frame(720, 1280, CV_8UC3);
+        cv::randu(frame, 0, 255);
+        frames.push_back(frame);
+    }
+
+    //both engines stay alive, so each RSS delta only counts that engine's own allocations
+    double before = rss_mb();
+    InferEngine fp32(fp32_path);
+    Run base = run_model(fp32, {frames.front()});
+    base.load_mb = rss_mb() - before;
+    before = rss_mb();
+    InferEngine int8(int8_path);
+    Run quant = run_model(int8, {frames.front()});
+    quant.load_mb = rss_mb() - before;
+
+    const double load_fp32 = base.load_mb, load_int8 = quant.load_mb;
+    base = run_model(fp32, frames);
+    quant = run_model(int8, frames);
+
+    size_t n_base = 0, n_quant = 0, matched = 0;
+    double iou_sum = 0, conf_shift = 0;
+    for (size_t f = 0; f < frames.size(); ++f) {
+        const auto& ref = base.detections[f];
+        const auto& cand = quant.detections[f];
+        n_base += ref.size();
+        n_quant += cand.size();
+        vector<bool> used(cand.size(), false);
+        for (const auto& d : ref) {
+            double best = 0.5;
+            int best_j = -1;
+            for (size_t j = 0; j < cand.size(); ++j) {
+                if (used[j] || cand[j].cls != d.cls) continue;
+                const double inter = (d.box & cand[j].box).area();
+                const double iou = inter / (d.box.area() + cand[j].box.area() - inter);
+                if (iou >= best) { best = iou; best_j = static_cast<int>(j); }
+            }
+            if (best_j >= 0) {
+                used[best_j] = true;
+                matched++;
+                iou_sum += best;
+                conf_shift += cand[best_j].conf - d.conf;
+            }
+        }
+    }
+
+    cout << "FP32 " << fp32_path << " vs " << (int8.isQuantized() ? int8.getQuantization() : "unquantized")
+         << " " << int8_path << ", " << frames.size() << (synthetic ? " random" : " video") << " frames\n";
+    cout << left << setw(8) << "model" << setw(12) << "load MB" << setw(10) << "p50 ms" << setw(10) << "p90 ms"
+         << setw(10) << "mean ms" << "detections\n";
+    auto row = [&](const char* name, double mb, const Run& r, size_t dets) {
+        const double mean = accumulate(r.latency_ms.begin(), r.latency_ms.end(), 0.0) / r.latency_ms.size();
+        cout << left << setw(8) << name << setw(12) << fixed << setprecision(1) << mb
+             << setw(10) << setprecision(2) << percentile(r.latency_ms, 0.5)
+             << setw(10) << percentile(r.latency_ms, 0.9) << setw(10) << mean << dets << "\n";
+    };
+    row("fp32", load_fp32, base, n_base);
+    row("int8", load_int8, quant, n_quant);
+
+    cout << "speedup (p50): " << setprecision(2) << percentile(base.latency_ms, 0.5) / percentile(quant.latency_ms, 0.5) << "x\n";
+    cout << "agreement: recall " << setprecision(3) << (n_base ? double(matched) / n_base : 1.0)
+         << ", precision " << (n_quant ? double(matched) / n_quant : 1.0)
+         << ", mean IoU " << (matched ? iou_sum / matched : 0.0)
+         << ", mean conf shift " << showpos << (matched ? conf_shift / matched : 0.0) << noshowpos << "\n";
+    return 0;
+}
@@ -0,0 +1,79 @@
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <unistd.h>
+#include <opencv2/opencv.hpp>
+#include "../headers/infer_engine.h"
+#include "../headers/engine_factory.h"
+#include "../headers/preprocess.h"
+
+using namespace std;
+
+// Resident memory against session count, for independent engines (one Env, thread pools
+// and weight copy each) and for engines from one EngineFactory. Every configuration runs
+// in a fresh child process so freed memory from an earlier one cannot hide growth.
+// Linux only: RSS is read from /proc/self/statm.
+
+static double rss_mb() {
+    ifstream statm("/proc/self/statm");
+    long pages = 0, resident = 0;
+    statm >> pages >> resident;
+    return resident * static_cast<double>(sysconf(_SC_PAGESIZE)) / (1024.0 * 1024.0);
+}
+
+static int child(const string& mode, int sessions, const string& model_path) {
+    cv::Mat frame(720, 1280, CV_8UC3);
+    cv::randu(frame, 0, 255);
+    const double base = rss_mb();
+
+    unique_ptr<EngineFactory> factory;
+    if (mode == "factory") factory = make_unique<EngineFactory>();
+    vector<unique_ptr<InferEngine>> engines;
+    for (int i = 0; i < sessions; ++i) {
+        engines.push_back(factory ? factory->create(model_path) : make_unique<InferEngine>(model_path));
+    }
+    //one run each, so lazily created kernels and buffers are counted too
+    Preprocessor pre(engines[0]->getInputWidth(), engines[0]->getInputHeight());
+    for (auto& engine : engines) {
+        pre.processInto(frame, engine->inputData());
+        engine->infer();
+    }
+    cout << fixed << setprecision(1) << rss_mb() - base << endl;
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc == 5 && string(argv[1]) == "--child") {
+        return child(argv[2], stoi(argv[3]), argv[4]);
+    }
+
+    const string model_path = (argc > 1) ? argv[1] : "yolov8n.onnx";
+    const int max_sessions = (argc > 2) ? stoi(argv[2]) : 16;
+    if (!ifstream(model_path).good()) {
+        cerr << "Model not found: " << model_path << "\n";
+        return 1;
+    }
+
+    auto measure = [&](const string& mode, int n) {
+        const string cmd = string(argv[0]) + " --child " + mode + " " + to_string(n) + " " + model_path + " 2>/dev/null";
+        string out;
+        if (FILE* p = popen(cmd.c_str(), "r")) {
+            char buf[64];
+            while (fgets(buf, sizeof(buf), p)) out = buf;  //last line is the RSS figure
+            pclose(p);
+        }
+        return out.empty() ? -1.0 : stod(out);
+    };
+
+    cout << "Resident memory added by N sessions of " << model_path << " (MB)\n";
+    cout << left << setw(10) << "sessions" << setw(14) << "independent" << "factory\n";
+    for (int n = 1; n <= max_sessions; n *= 2) {
+        cout << left << setw(10) << n << setw(14) << fixed << setprecision(1) << measure("independent", n)
+             << measure("factory", n) << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,58 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <fstream>
+#include <vector>
+#include <algorithm>
+#include <opencv2/opencv.hpp>
+#include "../headers/infer_engine.h"
+#include "../headers/preprocess.h"
+
+using namespace std;
+
+// First-frame latency with and without warm-up at load. Each mode loads a fresh engine,
+// then times the first real frame and the median of the next `steady` frames; the
+// first frame of an engine loaded without warm-up pays for ORT's arena allocation and
+// memory planning. Load time includes the warm-up, which the pipeline runs before its
+// producer reads a frame.
+int main(int argc, char** argv) {
+    const string model_path = (argc > 1) ? argv[1] : "yolov8n.onnx";
+    const int rounds = (argc > 2) ? stoi(argv[2]) : 3;
+    const int steady = 50;
+    if (!ifstream(model_path).good()) {
+        cerr << "Model not found: " << model_path << "\n";
+        return 1;
+    }
+
+    cv::Mat frame(720, 1280, CV_8UC3);
+    cv::randu(frame, 0, 255);
+
+    cout << "First-frame latency of " << model_path << ", best of " << rounds << " (ms)\n";
+    cout << left << setw(14) << "warm-up runs" << setw(12) << "load" << setw(14) << "first frame"
+         << "steady p50\n";
+    for (int runs : {0, 1, 3, 10}) {
+        double best_load = 1e30, best_first = 1e30, best_p50 = 1e30;
+        for (int r = 0; r < rounds; ++r) {
+            SessionConfig config;
+            config.warmup_runs = runs;
+            auto start = chrono::steady_clock::now();
+            InferEngine engine(model_path, config);
+            best_load = min(best_load, chrono::duration<double, milli>(chrono::steady_clock::now() - start).count());
+
+            Preprocessor pre(engine.getInputWidth(), engine.getInputHeight());
+            vector<double> times;
+            for (int i = 0; i <= steady; ++i) {
+                auto t = chrono::steady_clock::now();
+                pre.processInto(frame, engine.inputData());
+                engine.infer();
+                times.push_back(chrono::duration<double, milli>(chrono::steady_clock::now() - t).count());
+            }
+            best_first = min(best_first, times[0]);
+            nth_element(times.begin() + 1, times.begin() + 1 + steady / 2, times.end());
+            best_p50 = min(best_p50, times[1 + steady / 2]);
+        }
+        cout << left << setw(14) << runs << setw(12) << fixed << setprecision(1) << best_load << setw(14)
+             << best_first << best_p50 << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,86 @@
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <opencv2/opencv.hpp>
+#include "../headers/infer_engine.h"
+#include "../headers/frame_queue.h"
+#include "../headers/reorder_buffer.h"
+#include "../headers/metrics.h"
+#include "../headers/nms.h"
+
+using namespace std;
+
+extern void consumer(FrameQueue& fq, InferEngine& engine, ReorderBuffer& out, Metrics& metrics,
+                     atomic<bool>& running, const PostprocessConfig& post);
+
+// Runs the full consumer pipeline on `n` synthetic 640x480 frames with `workers`
+// inference threads and returns frames per second, measured from the first push
+// until the last frame leaves the reorder buffer.
+static double run_workers(const string& model_path, size_t workers, bool shared, int n) {
+    vector<unique_ptr<InferEngine>> engines;
+    engines.push_back(make_unique<InferEngine>(model_path));
+    for (size_t w = 1; w < workers; ++w) {
+        engines.push_back(shared ? engines[0]->withSharedSession() : make_unique<InferEngine>(model_path));
+    }
+
+    cv::Mat frame(480, 640, CV_8UC3);
+    cv::randu(frame, 0, 255);
+
+    FrameQueue fq(24);
+    size_t written = 0;
+    ReorderBuffer ordered([&](const cv::Mat&) { written++; });
+    atomic<bool> running{true};
+    Metrics metrics;
+
+    //keep consumer log lines out of the measurement output
+    ostringstream sink;
+    auto* cout_buf = cout.rdbuf(sink.rdbuf());
+    auto* cerr_buf = cerr.rdbuf(sink.rdbuf());
+
+    auto start = chrono::steady_clock::now();
+    vector<thread> threads;
+    for (auto& engine : engines) {
+        threads.emplace_back(consumer, ref(fq), ref(*engine), ref(ordered), ref(metrics), ref(running), PostprocessConfig{0.25f, 0.6f});
+    }
+    for (int i = 0; i < n; ++i) {
+        //each frame gets its own buffer, as the pool-backed producer would provide
+        fq.push(frame.clone());
+    }
+    running = false;
+    fq.close();
+    for (auto& t : threads) t.join();
+    double secs = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    cout.rdbuf(cout_buf);
+    cerr.rdbuf(cerr_buf);
+    if (written != static_cast<size_t>(n)) {
+        cerr << "warning: " << written << " of " << n << " frames written\n";
+    }
+    return n / secs;
+}
+
+int main(int argc, char** argv) {
+    const string model_path = (argc > 1) ? argv[1] : "yolov8n.onnx";
+    const int n = (argc > 2) ? stoi(argv[2]) : 200;
+    const size_t max_workers = (argc > 3) ? stoul(argv[3]) : max(2u, thread::hardware_concurrency());
+
+    cout << "Consumer throughput, " << n << " frames, model " << model_path
+         << " (" << thread::hardware_concurrency() << " hardware threads)\n";
+    cout << left << setw(10) << "workers" << setw(16) << "own sessions" << setw(16) << "shared session" << "scaling\n";
+    double base = 0.0;
+    for (size_t w = 1; w <= max_workers; w *= 2) {
+        double own = run_workers(model_path, w, false, n);
+        double shared = run_workers(model_path, w, true, n);
+        if (w == 1) base = own;
+        cout << left << setw(10) << w
+             << setw(16) << fixed << setprecision(1) << own
+             << setw(16) << shared
+             << setprecision(2) << own / base << "x\n";
+    }
+    return 0;
+}
@@ -0,0 +1,101 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <opencv2/opencv.hpp>
+#include "nms.h"
+
+/// Maps boxes from model input coordinates back to the source frame: undo the letterbox
+/// offset, then the resize scale, and clamp to the frame.
+struct LetterboxMap {
+    float scale = 1.0f;
+    float x_offset = 0.0f;
+    float y_offset = 0.0f;
+    cv::Size image_size;
+};
+
+/// Shape of a YOLOv8 detection head: how many classes it scores and which way round
+/// the ONNX export laid it out. Read from the model's output dims once it is loaded,
+/// so heads with any class count go through the same decoder.
+struct HeadLayout {
+    enum class Order {
+        Auto,          ///< channel-major if the rows are 4 + num_classes, else anchor-major
+        ChannelMajor,  ///< [4 + C, N], as Ultralytics exports it
+        AnchorMajor    ///< [N, 4 + C]
+    };
+
+    int num_classes = 80;
+    Order order = Order::Auto;
+    int num_anchors = 0;  ///< 0 when the output dims leave it dynamic
+
+    int channels() const { return 4 + num_classes; }
+
+    /// Derives the layout from an output shape of [1, 4 + C, N] or [1, N, 4 + C] and the
+    /// model input size. The side holding the anchor count of a stride 8/16/32 head for
+    /// that input (8400 at 640x640) is the anchor side; failing that, the narrower fixed
+    /// side is taken as the channels. Returns false, leaving `layout` untouched, for any
+    /// other rank or when no side can hold at least one class.
+    static bool fromModel(const std::vector<int64_t>& output_dims, int input_width, int input_height,
+                          HeadLayout& layout);
+
+    /// Anchors a stride 8/16/32 YOLOv8 head produces for this input size.
+    static int anchorsFor(int input_width, int input_height);
+
+    /// e.g. "4 classes, channel-major [8, 8400]", for logs.
+    std::string describe() const;
+
+    bool operator==(const HeadLayout& other) const {
+        return num_classes == other.num_classes && order == other.order && num_anchors == other.num_anchors;
+    }
+    bool operator!=(const HeadLayout& other) const { return !(*this == other); }
+};
+
+/// Turns a YOLOv8 detection head into candidate detections.
+///
+/// The head is 4 box values (cx, cy, w, h) plus one score per class for every anchor.
+/// The ONNX export emits it channel-major, [4 + C, N]: decoding that layout in place
+/// finds each anchor's best class with contiguous loads across anchors, one class
+/// plane at a time, and only maps boxes for anchors that reach the threshold. No
+/// transpose is needed. Anchor-major [N, 4 + C] input is decoded row by row.
+///
+/// The class count comes from the HeadLayout, so a 4-class head (8 channels) reads 4
+/// class planes instead of 80.
+class YoloDecoder {
+public:
+    explicit YoloDecoder(const HeadLayout& head = HeadLayout());
+
+    /// Appends one detection per anchor whose best class score reaches conf_threshold,
+    /// in anchor order. With Order::Auto the layout is told apart by which side is
+    /// 4 + num_classes wide; an explicit order requires that side. Returns false
+    /// (appending nothing) for any other shape or a non-CV_32F Mat.
+    bool decode(const cv::Mat& predictions, const LetterboxMap& map, float conf_threshold,
+                std::vector<Detection>& out) const;
+
+    int numClasses() const { return head_.num_classes; }
+    const HeadLayout& head() const { return head_; }
+
+    /// Restricts decoding to these class indices: the other class planes are not read,
+    /// so an anchor's best class is the best among them. Indices outside the head are
+    /// ignored, so a list with no valid index decodes nothing; an empty list restores
+    /// all classes.
+    void setClasses(const std::vector<int>& classes);
+    const std::vector<int>& classes() const { return classes_; }
+
+    /// Select the AVX2 class-scan kernel (default: whenever the CPU supports it) or the
+    /// scalar fallback. Both produce identical detections.
+    void useSimd(bool enabled);
+    bool simdEnabled() const { return use_simd_; }
+
+    /// Whether this build and CPU can run the AVX2 kernel.
+    static bool simdAvailable();
+
+private:
+    void decodeChannelMajor(const cv::Mat& predictions, const LetterboxMap& map, float conf_threshold,
+                            std::vector<Detection>& out) const;
+    void decodeAnchorMajor(const cv::Mat& predictions, const LetterboxMap& map, float conf_threshold,
+                           std::vector<Detection>& out) const;
+
+    HeadLayout head_;
+    std::vector<int> classes_;  // class planes scanned, ascending
+    bool use_simd_;
+};
@@ -0,0 +1,39 @@
+#pragma once
+#include <onnxruntime_cxx_api.h>
+#include <memory>
+#include <string>
+#include "infer_engine.h"
+#include "session_config.h"
+
+/// Creates InferEngines that share one ONNX Runtime runtime, so N sessions on one box do
+/// not pay N times for thread pools and prepacked weights.
+///
+/// All engines live in a single Ort::Env. With global_thread_pools (the default) that Env
+/// owns the only intra-op/inter-op pools, sized from the config's thread counts and used
+/// by every session; the per-session counts are then ignored. Sessions also share an
+/// OrtPrepackedWeightsContainer: operators that repack constant weights at load (GEMM
+/// and convolution kernels) keep one copy per model instead of one per session.
+///
+/// ORT keeps one Env per process, and whoever creates it first picks its threading. If
+/// an engine created elsewhere already holds a plain Env, sessions cannot use global
+/// pools. ORT then rejects the first session, create() falls back to per-session pools
+/// for it and every later one, and globalThreadPools() turns false. Other load errors
+/// are not retried. Create the factory before any standalone engine.
+///
+/// The factory may be destroyed before its engines; they keep the shared state alive.
+class EngineFactory {
+public:
+    explicit EngineFactory(const SessionConfig& config = SessionConfig(), bool global_thread_pools = true);
+
+    /// Loads `model_path` in a new session. Throws std::runtime_error if loading fails.
+    std::unique_ptr<InferEngine> create(const std::string& model_path);
+
+    const SessionConfig& config() const { return config_; }
+    bool globalThreadPools() const { return global_thread_pools_; }
+
+private:
+    SessionConfig config_;
+    bool global_thread_pools_;
+    std::shared_ptr<Ort::Env> env_;
+    std::shared_ptr<OrtPrepackedWeightsContainer> prepacked_;
+};
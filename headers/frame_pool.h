@@ -0,0 +1,43 @@
+#pragma once
+#include <mutex>
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+/// Fixed set of reusable frame buffers for the producer.
+///
+/// A buffer handed out by acquire() is an ordinary cv::Mat sharing its data with the
+/// pool. The pool keeps one reference to every buffer and treats a buffer as free again
+/// once it holds the only reference, so the refcounted cv::Mat itself is the RAII handle:
+/// when the consumer drops its last copy the buffer returns to the pool automatically.
+class FramePool {
+public:
+    explicit FramePool(size_t capacity);
+
+    /// (Re)allocate every buffer with the given geometry. Buffers still held elsewhere
+    /// stay valid for their holders and are simply no longer recycled.
+    void reserve(cv::Size size, int type);
+
+    /// Whether the pool's buffers have the geometry of `frame`.
+    bool matches(const cv::Mat& frame) const;
+
+    /// Returns a free buffer, or an empty Mat if the pool has not been reserved yet or
+    /// every buffer is still in use (the caller then falls back to a fresh allocation).
+    cv::Mat acquire();
+
+    size_t capacity() const { return capacity_; }
+    size_t available() const;
+
+    /// Number of acquire() calls that found no free buffer.
+    size_t misses() const;
+
+private:
+    static bool isFree(const cv::Mat& buffer);
+
+    mutable std::mutex mtx;
+    std::vector<cv::Mat> buffers;
+    size_t capacity_;
+    size_t next_ = 0;
+    size_t misses_ = 0;
+    cv::Size size_;
+    int type_ = -1;
+};
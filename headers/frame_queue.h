@@ -1,21 +1,57 @@
 #pragma once
-#include <queue>
+#include <vector>
 #include <mutex>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <condition_variable>
 #include <opencv2/opencv.hpp>
 
+/// Synchronisation strategy used by FrameQueue.
+enum class QueueMode {
+    Mutex,  ///< std::mutex + condition variables; any number of producers/consumers.
+    Spsc    ///< Lock-free ring buffer; exactly one producer thread and one consumer thread.
+};
+
+/// What push() does when the queue is full.
+enum class OverflowPolicy {
+    Block,       ///< Wait for the consumer to make room (every frame is processed).
+    DropOldest,  ///< Evict the oldest queued frame to make room for the new one.
+    DropNewest,  ///< Discard the incoming frame.
+    KeepLatest   ///< Discard everything queued so only the newest frame is waiting.
+};
+
 class FrameQueue {
 public:
-    explicit FrameQueue(size_t max_size = 10);
+    /// DropOldest and KeepLatest make the producer remove frames, so they are not
+    /// available with QueueMode::Spsc; that combination throws std::invalid_argument.
+    explicit FrameQueue(size_t max_size = 10, QueueMode mode = QueueMode::Mutex,
+                        OverflowPolicy policy = OverflowPolicy::Block);
     ~FrameQueue();
 
     /// Push a frame. Returns false if queue is closed or max_size==0.
+    /// A frame discarded by the overflow policy still counts as pushed.
     bool push(const cv::Mat& frame);
 
     /// Pop a frame. Blocks until data available or queue closed.
     /// Returns false if queue is empty AND closed.
     bool pop(cv::Mat& frame);
 
+    /// Same as pop(), also returning the frame's sequence number. Sequence numbers are
+    /// assigned in dequeue order starting at 0, so they stay gap-free even when the
+    /// overflow policy drops frames, and consumers can restore output order with them.
+    bool pop(cv::Mat& frame, uint64_t& seq);
+
+    /// Pop up to max_n frames at once. Returns as soon as max_n frames are queued
+    /// (or the queue is closed), otherwise when max_wait expires, taking whatever is
+    /// queued by then; `out` is cleared first and may stay empty on timeout.
+    /// In Mutex mode the whole batch is taken under a single lock acquisition.
+    /// Returns false if queue is empty AND closed.
+    /// If first_seq is given it receives the sequence number of out[0]; the rest follow
+    /// consecutively.
+    bool popBatch(std::vector<cv::Mat>& out, size_t max_n, std::chrono::microseconds max_wait,
+                  uint64_t* first_seq = nullptr);
+
     bool empty() const;
     size_t size() const;
 
@@ -25,12 +61,39 @@ public:
     /// Whether queue is closed.
     bool isClosed() const;
 
+    QueueMode mode() const { return mode_; }
+    OverflowPolicy policy() const { return policy_; }
+
+    /// Frames discarded by the overflow policy so far.
+    size_t droppedFrames() const { return dropped_.load(std::memory_order_relaxed); }
+
 private:
+    bool pushSpsc(const cv::Mat& frame);
+    bool popSpsc(cv::Mat& frame, uint64_t& seq);
+    bool popBatchSpsc(std::vector<cv::Mat>& out, size_t max_n, size_t want,
+                      std::chrono::steady_clock::time_point deadline, uint64_t* first_seq);
+
     mutable std::mutex mtx;
     std::condition_variable cv_push;
     std::condition_variable cv_pop;
 
-    std::queue<cv::Mat> q;
     size_t max_size;
-    bool closed;
+    std::atomic<bool> closed;
+    QueueMode mode_;
+    OverflowPolicy policy_;
+    std::atomic<size_t> dropped_{0};
+    uint64_t popped_ = 0;  // next sequence number; under mtx, or consumer-owned in Spsc mode
+
+    // Both modes store frames in a ring preallocated at construction, so steady-state
+    // push/pop never touches the heap. head_ and tail_ are free-running counters and
+    // the slot index is counter % max_size. In Mutex mode they are only accessed under
+    // mtx. In Spsc mode head_ is only written by the consumer and tail_ only by the
+    // producer; they live on separate cache lines so the two threads do not
+    // false-share, and mtx/cv_push/cv_pop are only used to park a side that has spun
+    // without progress.
+    std::vector<cv::Mat> ring_;
+    alignas(64) std::atomic<size_t> head_{0};
+    alignas(64) std::atomic<size_t> tail_{0};
+    alignas(64) std::atomic<bool> producer_parked_{false};
+    std::atomic<bool> consumer_parked_{false};
 };
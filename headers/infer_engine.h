@@ -1,25 +1,222 @@
 #pragma once
 #include <onnxruntime_cxx_api.h>
 #include <opencv2/opencv.hpp>
+#include <condition_variable>
+#include <functional>
+#include <future>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "session_config.h"
+#include "decoder.h"
+
+class ModelFile;
 
 class InferEngine {
 public:
     InferEngine(); // default constructor
-    explicit InferEngine(const std::string& model_path); // convenience constructor
+    explicit InferEngine(const std::string& model_path,
+                         const SessionConfig& config = SessionConfig()); // convenience constructor
+
+    /// Engine on a runtime shared with other engines; see EngineFactory. Sessions are
+    /// created in `env`, and share prepacked weights through `prepacked` when given.
+    /// With global_thread_pools they run on the Env's thread pools instead of their own.
+    InferEngine(std::shared_ptr<Ort::Env> env, std::shared_ptr<OrtPrepackedWeightsContainer> prepacked,
+                bool global_thread_pools);
     ~InferEngine(); // destructor
 
-    bool loadModel(const std::string& model_path);
+    /// Creates the session with `config` applied to its Ort::SessionOptions.
+    /// With config.optimized_model_dir set, a cached optimized graph is loaded instead of
+    /// the raw model when one matches; otherwise the optimized graph is written there for
+    /// the next start. With config.warmup_runs set, the engine is warmed up (see warmUp())
+    /// before this returns. With config.mmap_model the file is mapped read-only (see
+    /// model_file.h) and the session is created from the mapping; models that keep
+    /// weights in external data files need the default path loading.
+    bool loadModel(const std::string& model_path, const SessionConfig& config = SessionConfig());
+
+    /// Creates the session from a model already in memory, ONNX or ORT format, e.g. one
+    /// embedded in the binary. ORT copies the bytes during the call unless they are ORT
+    /// format and `bytes_outlive_engine` is set: then the session and its initializers use
+    /// them in place, so they must stay valid until this engine and every engine sharing
+    /// its session are gone. The optimized-model cache is keyed by file and not used here.
+    bool loadModelFromBuffer(const void* data, size_t size, const SessionConfig& config = SessionConfig(),
+                             bool bytes_outlive_engine = false);
+
+    /// Runs `runs` inferences on a constant mid-grey input, so ORT allocates its arenas,
+    /// plans memory and picks kernels before the first real frame instead of on it.
+    /// With max_batch > 1 the batch buffer is allocated too and, on a dynamic-batch model,
+    /// every batch size up to max_batch is run, since ORT plans each input shape
+    /// separately and a batch consumer cuts short batches of any size. Overwrites the
+    /// input buffers; logs the first and last run time.
+    void warmUp(int runs, int max_batch = 1);
+
+    /// Runs the model on a [1, 3, H, W] blob. The blob is copied into the engine's input
+    /// buffer unless it already is that buffer (see inputBlob()).
+    /// Returns the same non-owning view as infer().
     cv::Mat infer(const cv::Mat& input_blob);
 
+    /// Runs the model on whatever was written into inputData(). This is the zero-copy
+    /// path: Preprocessor::processInto(frame, engine.inputData()) followed by infer().
+    ///
+    /// Input and output are bound once through an Ort::IoBinding, so Run neither
+    /// allocates the output nor is it copied afterwards. The returned [C, N] Mat is a
+    /// view of the engine's output buffer: it is overwritten by the next infer() on this
+    /// engine and must not outlive the engine; clone() it to keep it.
+    cv::Mat infer();
+
+    /// Engine-owned input buffer of 3 * height * width floats (CHW), 64-byte aligned,
+    /// wrapped by an Ort::Value created once at load. Valid once a model is loaded.
+    float* inputData() { return input_blob_.ptr<float>(); }
+
+    /// The same buffer viewed as a [1, 3, H, W] Mat.
+    const cv::Mat& inputBlob() const { return input_blob_; }
+
+    /// Whether the model has a dynamic batch dimension, so inferBatch() runs all frames
+    /// in a single Run. Otherwise inferBatch() falls back to one Run per frame.
+    bool supportsBatch() const { return !input_dims_.empty() && input_dims_[0] <= 0; }
+
+    /// Input buffer for n frames, [n, 3, H, W]; frame i starts at i * 3 * H * W floats.
+    /// It only moves when n exceeds every earlier request.
+    float* batchInputData(size_t n);
+
+    /// Runs the first n frames written into batchInputData(n) as one [n, 3, H, W] tensor
+    /// and returns one [C, N] prediction view per frame. Like infer(), the views point
+    /// into engine-owned output memory and are overwritten by the next inferBatch().
+    std::vector<cv::Mat> inferBatch(size_t n);
+
+    /// Copies N [1, 3, H, W] blobs into the batch buffer and runs them as above.
+    std::vector<cv::Mat> inferBatch(const std::vector<cv::Mat>& blobs);
+
+    /// Prepares k request slots for inferAsync(), each with its own input and output
+    /// buffers, so k frames can be in flight at once. Waits for pending requests first.
+    void setAsyncSlots(size_t k);
+    size_t asyncSlots() const { return async_slots_.size(); }
+
+    /// Input buffer of one async slot: 3 * H * W floats (CHW), like inputData().
+    float* asyncInputData(size_t slot);
+
+    /// Called when an async request completes, with the slot and its [C, N] predictions.
+    using AsyncCallback = std::function<void(size_t slot, const cv::Mat& predictions)>;
+
+    /// Starts inference on what was written into asyncInputData(slot) and returns at once.
+    /// If the slot is still in flight, this first waits for it to finish.
+    ///
+    /// Requests run through Session::RunAsync on ORT's intra-op pool. If the session cannot
+    /// run asynchronously (its pool has no worker threads), they run on an engine-owned
+    /// executor thread instead. On completion `on_done` runs on that thread, then the
+    /// future becomes ready. The predictions view the slot's output buffer and stay valid
+    /// until the slot is submitted again. Run errors surface through the future.
+    std::future<cv::Mat> inferAsync(size_t slot, AsyncCallback on_done = nullptr);
+
+    /// Whether inferAsync() fell back to the executor thread.
+    bool asyncUsesExecutor() const { return use_executor_; }
+
+    /// Creates another engine running on this engine's Ort::Session (Session::Run is
+    /// thread-safe). Only the session is shared, so each worker thread gets its own engine.
+    std::unique_ptr<InferEngine> withSharedSession() const;
+
+    /// Input resolution read from the model at load; dynamic H/W fall back to 640.
     int getInputWidth() const { return input_width_; }
     int getInputHeight() const { return input_height_; }
 
+    /// Model I/O as declared by the model, read once at load. Dynamic dims are -1.
+    const std::string& getInputName() const { return input_name_; }
+    const std::string& getOutputName() const { return output_name_; }
+    const std::vector<int64_t>& getInputDims() const { return input_dims_; }
+    const std::vector<int64_t>& getOutputDims() const { return output_dims_; }
+
+    /// Detection head layout, read from the output dims once at load. When they do not
+    /// tell (headKnown() false) this is the 80-class COCO head.
+    const HeadLayout& head() const { return head_; }
+    bool headKnown() const { return head_known_; }
+
+    /// Session settings the model was loaded with.
+    const SessionConfig& getSessionConfig() const { return config_; }
+
+    /// Quantization of the loaded model: the "quantization" metadata written by
+    /// models/quantize_model.py (e.g. "int8-static-qdq"), "int8" for other models with
+    /// quantized operators, or empty for a float model. Input and output stay float
+    /// either way, so the rest of the pipeline is unchanged.
+    const std::string& getQuantization() const { return quantization_; }
+    bool isQuantized() const { return !quantization_.empty(); }
+
+    /// Whether the session came from the optimized-model cache.
+    bool loadedFromCache() const { return loaded_from_cache_; }
+
+    /// Why the last session creation failed, as reported by ORT; empty once one succeeds.
+    const std::string& lastLoadError() const { return load_error_; }
+
 private:
-    std::unique_ptr<Ort::Session> session_;
-    Ort::Env env_;
+    bool createSession(const std::string& path, Ort::SessionOptions& options);
+    bool createSession(const void* data, size_t size, Ort::SessionOptions& options, bool bytes_persist,
+                       std::shared_ptr<const ModelFile> owner);
+    bool finishLoad(const std::string& source, const SessionConfig& config, std::string_view bytes);
+    bool readModelInfo();
+    void allocateIo();
+    void bindBatch(size_t n);
+    bool hasStaticOutput() const;
+
+    struct AsyncSlot;
+    static void onRunAsyncDone(void* user_data, OrtValue** outputs, size_t num_outputs, OrtStatusPtr status);
+    void completeAsync(AsyncSlot& slot, const std::string& error);
+    void executorLoop();
+    void waitForAsync();
+
+    std::shared_ptr<Ort::Env> env_;
+    std::shared_ptr<OrtPrepackedWeightsContainer> prepacked_;
+    bool global_thread_pools_ = false;
+    // Mapping the session reads its weights from in place, if any. Declared before
+    // session_ so that it outlives the session.
+    std::shared_ptr<const ModelFile> model_bytes_;
+    std::shared_ptr<Ort::Session> session_;
     std::string model_path_;
+    SessionConfig config_;
+    bool loaded_from_cache_ = false;
+    std::string load_error_;
+    std::string quantization_;
     int input_width_ = 640;
     int input_height_ = 640;
+
+    std::string input_name_;
+    std::string output_name_;
+    std::vector<int64_t> input_dims_;
+    std::vector<int64_t> output_dims_;
+    HeadLayout head_;
+    bool head_known_ = false;
+
+    // Per-engine (so per-worker) I/O, bound once; OpenCV allocates Mat data 64-byte aligned.
+    // The output is bound to output_blob_ when the model's output dims are static;
+    // otherwise ORT allocates it and dynamic_outputs_ keeps it alive for the view.
+    cv::Mat input_blob_;
+    cv::Mat output_blob_;
+    Ort::MemoryInfo memory_info_{nullptr};
+    Ort::Value input_tensor_{nullptr};
+    Ort::Value output_tensor_{nullptr};
+    Ort::IoBinding io_binding_{nullptr};
+    Ort::RunOptions run_options_;
+    std::vector<Ort::Value> dynamic_outputs_;
+
+    // Batch I/O, sized on first use and re-bound whenever the batch size changes.
+    cv::Mat batch_input_;
+    cv::Mat batch_output_;
+    size_t batch_capacity_ = 0;
+    size_t batch_bound_ = 0;
+    Ort::Value batch_input_tensor_{nullptr};
+    Ort::Value batch_output_tensor_{nullptr};
+    Ort::IoBinding batch_binding_{nullptr};
+    std::vector<Ort::Value> batch_outputs_;
+
+    // Async requests. async_mtx_ guards slot busy flags, the pending count and the
+    // executor queue; async_cv_ signals all three.
+    std::vector<std::unique_ptr<AsyncSlot>> async_slots_;
+    std::mutex async_mtx_;
+    std::condition_variable async_cv_;
+    size_t async_pending_ = 0;
+    bool use_executor_ = false;
+    bool executor_stop_ = false;
+    std::vector<AsyncSlot*> executor_jobs_;
+    std::thread executor_;
 };
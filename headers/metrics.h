@@ -0,0 +1,189 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+/// Pipeline stages that are timed per frame.
+enum class Stage : size_t {
+    Decode,       ///< VideoCapture::read in the producer.
+    QueueWait,    ///< Time a consumer spends blocked in FrameQueue::pop.
+    Preprocess,   ///< Letterbox, colour conversion and blob packing.
+    Inference,    ///< InferEngine::infer (ORT Run plus tensor wrapping).
+    Postprocess,  ///< Output decoding and NMS.
+    Draw,         ///< Boxes and labels drawn onto the frame.
+    Encode,       ///< VideoWriter::write.
+    Count
+};
+
+/// Event counters kept next to the histograms.
+enum class Counter : size_t {
+    FramesDecoded,
+    FramesProcessed,
+    FramesDropped,
+    Detections,
+    Count
+};
+
+const char* stageName(Stage stage);
+const char* counterName(Counter counter);
+
+/// Log-linear latency histogram in the spirit of HdrHistogram: values below
+/// 2^kSubBucketBits nanoseconds are exact, above that every power of two is split into
+/// 2^(kSubBucketBits-1) buckets, so any recorded value is reported within ~1.6%.
+/// Values are clamped to kMaxValue (about 18 minutes).
+///
+/// A histogram has a single writer (the thread that owns it); record() uses plain
+/// relaxed load/store pairs instead of locked read-modify-write instructions.
+/// Readers may merge it concurrently and see a slightly stale but consistent-enough view.
+class LatencyHistogram {
+public:
+    static constexpr int kSubBucketBits = 7;
+    static constexpr uint64_t kMaxValue = (uint64_t(1) << 40) - 1;
+    static constexpr size_t kBucketCount =
+        (40 - kSubBucketBits + 2) * (size_t(1) << (kSubBucketBits - 1));
+
+    static size_t bucketIndex(uint64_t value);
+    /// Largest value that falls into bucket idx.
+    static uint64_t bucketUpperBound(size_t idx);
+
+    void record(uint64_t value_ns);
+
+private:
+    friend class HistogramSnapshot;
+    std::array<std::atomic<uint64_t>, kBucketCount> buckets_{};
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> sum_{0};
+    std::atomic<uint64_t> max_{0};
+};
+
+/// Plain copy of one or more merged histograms, used for reporting.
+class HistogramSnapshot {
+public:
+    HistogramSnapshot();
+
+    void merge(const LatencyHistogram& hist);
+
+    uint64_t count() const { return count_; }
+    uint64_t max() const { return max_; }
+    double mean() const { return count_ ? static_cast<double>(sum_) / count_ : 0.0; }
+
+    /// Value at quantile q in [0, 1], reported as the upper bound of its bucket.
+    uint64_t percentile(double q) const;
+
+private:
+    std::vector<uint64_t> buckets_;
+    uint64_t count_ = 0;
+    uint64_t sum_ = 0;
+    uint64_t max_ = 0;
+};
+
+/// Histograms and counters owned by one thread. Only that thread writes to it.
+struct alignas(64) ThreadMetrics {
+    std::array<LatencyHistogram, static_cast<size_t>(Stage::Count)> stages;
+    std::array<std::atomic<uint64_t>, static_cast<size_t>(Counter::Count)> counters{};
+
+    void record(Stage stage, std::chrono::nanoseconds elapsed) {
+        stages[static_cast<size_t>(stage)].record(static_cast<uint64_t>(elapsed.count()));
+    }
+
+    void add(Counter counter, uint64_t n = 1) {
+        auto& c = counters[static_cast<size_t>(counter)];
+        c.store(c.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+};
+
+/// Process-wide metrics registry. Each thread records into its own ThreadMetrics,
+/// obtained once through local(), so the hot path never contends on shared cache
+/// lines; snapshots merge all threads on demand.
+class Metrics {
+public:
+    Metrics();
+    Metrics(const Metrics&) = delete;
+    Metrics& operator=(const Metrics&) = delete;
+
+    /// Block for the calling thread, registered on first use. The reference stays
+    /// valid for the lifetime of this Metrics object. A thread recording into several
+    /// Metrics objects keeps one block in each.
+    ThreadMetrics& local();
+
+    /// Merged latency distribution of one stage across all threads.
+    HistogramSnapshot stage(Stage stage) const;
+
+    /// Sum of one counter across all threads.
+    uint64_t counter(Counter counter) const;
+
+    /// Seconds since construction or the last restartClock().
+    double uptime() const;
+
+    /// Restarts uptime, and so the overall FPS, from now. Used once startup work such as
+    /// model warm-up is done, so it does not count against the frame rate.
+    void restartClock();
+
+    /// Single-line JSON report: counters, overall FPS and p50/p90/p99/max/mean per
+    /// stage in milliseconds.
+    std::string toJson() const;
+
+private:
+    const uint64_t id_;
+    std::atomic<std::chrono::steady_clock::rep> start_;  // steady_clock ticks, read by the reporter
+    mutable std::mutex mtx;
+    std::vector<std::unique_ptr<ThreadMetrics>> threads_;
+};
+
+/// Records the time between construction and destruction into one stage.
+class ScopedStageTimer {
+public:
+    ScopedStageTimer(ThreadMetrics& tm, Stage stage)
+        : tm_(tm), stage_(stage), start_(std::chrono::steady_clock::now()) {}
+    ~ScopedStageTimer() { stop(); }
+
+    /// Record now instead of at scope exit; later calls do nothing.
+    void stop() {
+        if (stopped_) return;
+        stopped_ = true;
+        tm_.record(stage_, std::chrono::steady_clock::now() - start_);
+    }
+
+    ScopedStageTimer(const ScopedStageTimer&) = delete;
+    ScopedStageTimer& operator=(const ScopedStageTimer&) = delete;
+
+private:
+    ThreadMetrics& tm_;
+    Stage stage_;
+    std::chrono::steady_clock::time_point start_;
+    bool stopped_ = false;
+};
+
+/// Background thread writing Metrics::toJson() to `out` every `interval`, one JSON
+/// object per line. A zero interval disables periodic reports. stop() (or the
+/// destructor) writes a final report marked "final": true.
+class MetricsReporter {
+public:
+    MetricsReporter(const Metrics& metrics, std::ostream& out, std::chrono::milliseconds interval);
+    ~MetricsReporter();
+
+    void stop();
+
+private:
+    void run();
+    void emit(bool final_report);
+
+    const Metrics& metrics_;
+    std::ostream& out_;
+    std::chrono::milliseconds interval_;
+    std::mutex mtx;
+    std::condition_variable cv;
+    bool stopping_ = false;
+    bool stopped_ = false;
+    uint64_t last_processed_ = 0;
+    double last_uptime_ = 0.0;
+    std::thread thread_;
+};
@@ -0,0 +1,25 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include "session_config.h"
+
+/// On-disk cache of ORT-optimized models, so a process start can skip graph optimization.
+///
+/// Entries are saved in ORT's flatbuffer format, which also loads without protobuf
+/// parsing. The file name is keyed by a hash of the model bytes, the ORT library version
+/// and the graph optimization level. A retrained model, an ORT upgrade or a different
+/// --opt-level therefore never picks up a stale entry. At level "all", ORT adds layout
+/// transforms tuned to the CPU's vector width, so the key also names the widest x86
+/// SIMD level available. Thread and memory settings do not change the saved graph and
+/// are not part of the key.
+namespace model_cache {
+
+/// 64-bit FNV-1a hash of a file's contents. Returns false if it cannot be read.
+bool hashFile(const std::string& path, uint64_t& hash);
+
+/// Path of the cache entry for this model and config inside `cache_dir`, or an empty
+/// string if the model cannot be read.
+std::string entryPath(const std::string& cache_dir, const std::string& model_path,
+                      const SessionConfig& config);
+
+} // namespace model_cache
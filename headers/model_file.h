@@ -0,0 +1,32 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+/// Read-only bytes of a model file, memory-mapped so that every process loading the
+/// same file shares one copy in the page cache instead of holding a private one.
+///
+/// Whether the sharing survives session creation depends on the format. ORT parses an
+/// ONNX protobuf into its own tensors, so the mapping only saves the read buffer. An ORT
+/// format model (e.g. an optimized-model cache entry, see model_cache.h) can keep its
+/// initializers inside the mapping; InferEngine asks for that when it maps the file.
+class ModelFile {
+public:
+    ModelFile() = default;
+    ~ModelFile();
+
+    ModelFile(const ModelFile&) = delete;
+    ModelFile& operator=(const ModelFile&) = delete;
+
+    /// Maps `path` read-only. Returns false and fills `error` if it cannot.
+    bool map(const std::string& path, std::string& error);
+
+    const void* data() const { return data_; }
+    size_t size() const { return size_; }
+
+    /// Whether the bytes are an ORT format (flatbuffer) model rather than ONNX protobuf.
+    static bool isOrtFormat(const void* data, size_t size);
+
+private:
+    void* data_ = nullptr;
+    size_t size_ = 0;
+};
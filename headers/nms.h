@@ -3,15 +3,95 @@
 #include <vector>
 #include <opencv2/opencv.hpp>
 
+struct HeadLayout;
+
 struct Detection {
     cv::Rect2f box;
     float conf;
     int cls;
 };
 
+/// Thresholds and caps applied by postprocess(). The caps follow the Ultralytics
+/// pipeline: only the top_k most confident candidates go through NMS (its max_nms)
+/// and at most max_det detections come out. They bound postprocess time when a low
+/// conf_threshold lets thousands of anchors through.
+struct PostprocessConfig {
+    float conf_threshold = 0.25f;
+    float iou_threshold = 0.45f;
+    int top_k = 1000;   ///< candidates passed to NMS, most confident first; 0 keeps all
+    int max_det = 300;  ///< detections returned, most confident first; 0 keeps all
+    std::vector<int> classes;  ///< class indices to detect; empty detects every class
+};
+
+/// Greedy class-aware NMS: sorts by confidence, then drops every box whose IoU with a
+/// higher-scoring kept box of the same class exceeds iou_threshold. Compares all pairs.
+void applyNMS(std::vector<Detection>& detections, float iou_threshold);
+
+/// Same greedy NMS with the same result and order as applyNMS, but candidates are
+/// handled one class at a time and kept boxes are bucketed in a uniform grid, so a box
+/// is only compared against kept boxes that share a grid cell with it. The few kept
+/// boxes spanning more than a handful of cells are compared against every candidate
+/// instead. Boxes that do not overlap cannot exceed a non-negative IoU threshold, so
+/// nothing is missed.
+///
+/// Every buffer is bounded by the candidate count, the class range or the fixed grid
+/// size, never by where the boxes fall, so after reserve() calls with at most that
+/// many candidates do not allocate. Use one instance per thread.
+class GridNms {
+public:
+    void apply(std::vector<Detection>& detections, float iou_threshold);
+
+    /// Sizes the buffers for up to max_detections candidates of up to num_classes classes.
+    void reserve(size_t max_detections, int num_classes);
+
+private:
+    std::vector<int> order_;       // detection indices grouped by class, best first
+    std::vector<int> class_start_;
+    std::vector<char> keep_;
+    std::vector<int> checked_;     // last candidate each kept box was compared with
+    std::vector<int> cell_head_;   // first entry of each cell for the current class, or -1
+    std::vector<int> entry_box_;   // cell entries: kept box and next entry in the cell
+    std::vector<int> entry_next_;
+    std::vector<int> large_;       // kept boxes of the current class too large to bucket
+    std::vector<int> used_cells_;
+};
+
 std::vector<Detection> postprocess(
     const cv::Mat& predictions,
     cv::Size original_image_size,
     float conf_threshold = 0.25f,
     float iou_threshold = 0.45f
-);
\ No newline at end of file
+);
+
+/// Same as above, but maps boxes back with the letterbox geometry the Preprocessor
+/// actually used (Preprocessor::getScaleAndPadding()) instead of recomputing it for
+/// an assumed 640x640 model input.
+std::vector<Detection> postprocess(
+    const cv::Mat& predictions,
+    cv::Size original_image_size,
+    float scale,
+    cv::Point padding,
+    float conf_threshold,
+    float iou_threshold
+);
+
+/// Same as above with the top-K and max-detections caps of `config`. Each call returns
+/// a fresh vector; per-frame callers use a Postprocessor (postprocess.h) instead.
+std::vector<Detection> postprocess(
+    const cv::Mat& predictions,
+    cv::Size original_image_size,
+    float scale,
+    cv::Point padding,
+    const PostprocessConfig& config
+);
+
+/// Same as above for a head described by `head` (decoder.h), e.g. a custom model with
+/// fewer classes than COCO. The overloads without it assume the 80-class head.
+std::vector<Detection> postprocess(
+    const cv::Mat& predictions,
+    cv::Size original_image_size,
+    float scale,
+    cv::Point padding,
+    const PostprocessConfig& config,
+    const HeadLayout& head
+);
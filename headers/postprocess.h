@@ -0,0 +1,49 @@
+#pragma once
+#include <vector>
+#include <opencv2/opencv.hpp>
+#include "nms.h"
+#include "decoder.h"
+
+/// Per-consumer postprocessing context: decode, top-K, NMS and max-det over buffers
+/// that are kept between frames.
+///
+/// Candidates are decoded straight into the output vector, trimmed and compacted in
+/// place by NMS, so no detection is copied to a second buffer. Every buffer is sized
+/// from the anchor count, top-K and class count on the first frame, so later frames of
+/// the same head do not allocate however many boxes they hold or where they fall. Use
+/// one per thread.
+///
+/// Classes outside config.classes are skipped by the decoder itself, so they cost
+/// neither class-plane reads nor NMS work.
+///
+/// The head layout defaults to the 80-class COCO head; consumers pass the one read from
+/// the loaded model (HeadLayout::fromModel), so custom class counts decode the same way.
+class Postprocessor {
+public:
+    explicit Postprocessor(const PostprocessConfig& config = PostprocessConfig(),
+                           const HeadLayout& head = HeadLayout());
+
+    /// Detections for one frame, mapped back with the Preprocessor's letterbox geometry
+    /// (Preprocessor::getScaleAndPadding()). The vector is owned by the Postprocessor and
+    /// overwritten by the next call. Empty for predictions that do not fit the head layout.
+    const std::vector<Detection>& process(const cv::Mat& predictions, cv::Size original_image_size,
+                                          float scale, cv::Point padding);
+
+    /// Same as process(), but into `out`, which is cleared first and keeps its capacity.
+    /// Returns false (leaving `out` empty) for predictions that do not fit the head layout.
+    bool processInto(const cv::Mat& predictions, const LetterboxMap& map, std::vector<Detection>& out);
+
+    const PostprocessConfig& config() const { return config_; }
+    void setConfig(const PostprocessConfig& config);
+
+    const HeadLayout& head() const { return decoder_.head(); }
+    /// Switches to another head layout, keeping the class filter of config(). Setting the
+    /// current layout again does nothing.
+    void setHead(const HeadLayout& head);
+
+private:
+    PostprocessConfig config_;
+    YoloDecoder decoder_;
+    GridNms nms_;
+    std::vector<Detection> detections_;
+};
@@ -7,13 +7,49 @@ using namespace std;
 class Preprocessor {
 public:
     Preprocessor(int input_width = 640, int input_height = 640);
-    cv::Mat process(const cv::Mat& image);
+
+    /// Letterbox `image` (8-bit BGR) into a [1, 3, H, W] float RGB blob scaled to [0, 1].
+    /// After the resize the image is read once: a fused kernel converts, normalizes and
+    /// writes the CHW planes directly. Returns an empty Mat for images that are not CV_8UC3.
+    ///
+    /// The blob lives in a workspace owned by the Preprocessor and is overwritten by the
+    /// next call; clone it to keep it longer. The workspace (letterbox geometry, padding,
+    /// resize buffer) is planned for the source resolution and only re-planned when it
+    /// changes, so steady-state calls do not allocate.
+    const cv::Mat& process(const cv::Mat& image);
+
+    /// Same as process(), but writes the 3*H*W CHW floats straight into `dst`, e.g. the
+    /// engine's input tensor (InferEngine::inputData()), skipping the workspace blob.
+    /// Padding is rewritten only when `dst` or the source resolution changes, so `dst`
+    /// must not be modified by anyone else between calls. Returns false for images that
+    /// are not CV_8UC3.
+    bool processInto(const cv::Mat& image, float* dst);
+
+    /// Letterbox geometry of the last processed frame: the resize scale and the (x, y)
+    /// offset of the image inside the blob. (1, (0, 0)) before the first frame.
     pair<float, cv::Point> getScaleAndPadding() const;
 
+    /// Select the AVX2 pack kernel (default: whenever the CPU supports it) or the
+    /// scalar fallback. Both produce bit-identical output.
+    void useSimd(bool enabled);
+    bool simdEnabled() const { return use_simd_; }
+
+    /// Whether this build and CPU can run the AVX2 pack kernel.
+    static bool simdAvailable();
+
 private:
     int input_width_;
     int input_height_;
 
     float scale_;
     cv::Point padding_; 
+
+    void plan(cv::Size frame_size);
+
+    bool use_simd_;
+    cv::Size planned_size_;  // source resolution the workspace is laid out for
+    float* padded_dst_ = nullptr;  // buffer whose padding matches the current plan
+    cv::Size content_size_;  // size of the resized image inside the letterbox
+    cv::Mat resized_;
+    cv::Mat blob_;
 };
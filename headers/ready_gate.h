@@ -0,0 +1,31 @@
+#pragma once
+#include <condition_variable>
+#include <mutex>
+
+/// One-shot startup gate between model loading and the producer.
+///
+/// The producer opens its video source while the engines load and warm up, then waits
+/// here before reading the first frame. No frame is decoded, or left to go stale in
+/// the queue, until every worker can serve it at steady-state latency.
+class ReadyGate {
+public:
+    /// Marks the pipeline ready and releases all waiters. Later calls do nothing.
+    void open();
+
+    /// Marks startup as failed and releases all waiters; wait() then returns false.
+    /// Does nothing once the gate is open.
+    void fail();
+
+    /// Blocks until open() or fail(). Returns true if the gate was opened.
+    bool wait();
+
+    /// Whether open() has been called.
+    bool isOpen() const;
+
+private:
+    enum class State { Waiting, Open, Failed };
+
+    mutable std::mutex mtx;
+    std::condition_variable cv;
+    State state_ = State::Waiting;
+};
@@ -0,0 +1,35 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <opencv2/opencv.hpp>
+
+/// Restores frame order after several workers processed frames concurrently.
+///
+/// Workers submit each result under the sequence number FrameQueue::pop() returned;
+/// the sink is called exactly once per sequence number, in increasing order, holding
+/// back results that arrive early. Every popped frame must be submitted (an empty Mat
+/// is fine) or later frames will wait forever.
+class ReorderBuffer {
+public:
+    using Sink = std::function<void(const cv::Mat&)>;
+
+    explicit ReorderBuffer(Sink sink, uint64_t first_seq = 0);
+
+    /// Thread-safe. The sink runs on the submitting thread with the buffer locked,
+    /// so sink calls are serialized.
+    void submit(uint64_t seq, const cv::Mat& frame);
+
+    /// Number of results waiting for an earlier sequence number.
+    size_t pending() const;
+
+    /// Sequence number the sink is waiting for next.
+    uint64_t nextSeq() const;
+
+private:
+    mutable std::mutex mtx;
+    Sink sink_;
+    uint64_t next_;
+    std::map<uint64_t, cv::Mat> pending_;
+};
@@ -0,0 +1,49 @@
+#pragma once
+#include <onnxruntime_cxx_api.h>
+#include <string>
+
+/// ONNX Runtime session settings, filled from CLI flags and/or a config file and applied
+/// when InferEngine creates its session. Zero thread counts keep ORT's own default
+/// (one intra-op thread per physical core), so the defaults behave like a plain
+/// Ort::SessionOptions.
+///
+/// Config files hold one `key = value` per line; '#' starts a comment. Keys:
+///   intra_op_threads  <int>                              threads inside one operator
+///   inter_op_threads  <int>                              threads across operators (parallel mode)
+///   execution_mode    sequential | parallel
+///   graph_optimization disable | basic | extended | all
+///   mem_pattern       true | false                      pre-plan allocations from the first run
+///   cpu_arena         true | false                      pool CPU allocations in an arena
+///   allow_spinning    true | false                      let idle pool threads busy-wait for work
+///   optimized_model_dir <path>                          cache optimized graphs here (see model_cache.h)
+///   mmap_model        true | false                      map the model file instead of reading it (see model_file.h)
+///   warmup_runs       <int>                              dummy inferences run at load (see InferEngine::warmUp)
+///   warmup_batch      <int>                              also warm up every batch size up to this one
+struct SessionConfig {
+    int intra_op_threads = 0;
+    int inter_op_threads = 0;
+    ExecutionMode execution_mode = ORT_SEQUENTIAL;
+    GraphOptimizationLevel graph_optimization = ORT_ENABLE_ALL;
+    bool mem_pattern = true;
+    bool cpu_arena = true;
+    bool allow_spinning = true;
+    std::string optimized_model_dir;  ///< empty: no optimized-model cache
+    bool mmap_model = false;
+    int warmup_runs = 0;
+    int warmup_batch = 1;
+
+    /// Sets one option by its config-file key. Returns false and fills `error` for an
+    /// unknown key or a malformed value.
+    bool set(const std::string& key, const std::string& value, std::string& error);
+
+    /// Reads a config file, applying its entries on top of the current values.
+    /// Stops at the first bad line; `error` names the file and line.
+    bool loadFile(const std::string& path, std::string& error);
+
+    /// Copies the settings into ORT session options. The optimized-model cache, model
+    /// mapping and warm-up are handled by InferEngine::loadModel, not here.
+    void apply(Ort::SessionOptions& options) const;
+
+    /// One-line summary for the startup log.
+    std::string describe() const;
+};
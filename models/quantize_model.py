@@ -0,0 +1,175 @@
+#!/usr/bin/env python3
+"""Quantize an exported YOLOv8 ONNX model to INT8 for ONNX Runtime on CPU.
+
+Two modes:
+  dynamic  Weights are quantized offline, activations at run time. No calibration
+           data is needed, but convolutions become ConvInteger, which is rarely faster
+           on CPU. Mainly a quick accuracy baseline.
+  static   QDQ (QuantizeLinear/DequantizeLinear) model with activation ranges
+           calibrated on frames sampled evenly from a local video, preprocessed
+           exactly as the C++ Preprocessor does (letterbox with 114 padding, BGR->RGB,
+           /255, CHW). ORT fuses the QDQ pairs into QLinearConv and other int8 kernels.
+
+The detection head's decode (box/class concatenation, DFL softmax, sigmoid) is left in
+float by default, because quantizing values with such different ranges into one scale
+costs most of the accuracy. The head's convolutions are quantized either way. The
+result records its precision in the model metadata ("quantization"), which InferEngine
+reports at load.
+
+Example:
+  python3 models/quantize_model.py --model yolov8n.onnx --mode static --video traffic.mp4
+"""
+
+import argparse
+from pathlib import Path
+
+import numpy as np
+import onnx
+
+HEAD_PREFIX = "/model.22/"  # Detect module in Ultralytics exports
+
+
+def letterbox_blob(frame, width, height):
+    import cv2
+
+    h, w = frame.shape[:2]
+    scale = min(width / w, height / h)
+    new_w, new_h = int(w * scale), int(h * scale)
+    pad_x, pad_y = (width - new_w) // 2, (height - new_h) // 2
+
+    canvas = np.full((height, width, 3), 114, dtype=np.uint8)
+    canvas[pad_y:pad_y + new_h, pad_x:pad_x + new_w] = cv2.resize(frame, (new_w, new_h),
+                                                                  interpolation=cv2.INTER_LINEAR)
+    rgb = canvas[:, :, ::-1].astype(np.float32) * np.float32(1.0 / 255.0)
+    return np.ascontiguousarray(rgb.transpose(2, 0, 1))[np.newaxis]
+
+
+def sample_frames(video, count):
+    """Up to `count` frames spread evenly over the clip, so calibration sees all of it."""
+    import cv2
+
+    cap = cv2.VideoCapture(str(video))
+    if not cap.isOpened():
+        raise SystemExit(f"Could not open calibration video {video}")
+    total = int(cap.get(cv2.CAP_PROP_FRAME_COUNT)) or count
+    stride = max(1, total // count)
+
+    frames, index = [], 0
+    while len(frames) < count:
+        ok, frame = cap.read()
+        if not ok:
+            break
+        if index % stride == 0:
+            frames.append(frame)
+        index += 1
+    cap.release()
+    if not frames:
+        raise SystemExit(f"No frames read from {video}")
+    return frames
+
+
+def input_info(model_path):
+    model = onnx.load(str(model_path), load_external_data=False)
+    inp = model.graph.input[0]
+    dims = [d.dim_value for d in inp.type.tensor_type.shape.dim]
+    height = dims[2] if len(dims) == 4 and dims[2] > 0 else 640
+    width = dims[3] if len(dims) == 4 and dims[3] > 0 else 640
+    return inp.name, width, height
+
+
+def head_nodes_to_exclude(model_path):
+    """Non-convolution nodes of the detection head, kept in float. Its Convs are not
+    listed, so they are quantized like the rest of the network."""
+    model = onnx.load(str(model_path), load_external_data=False)
+    return [n.name for n in model.graph.node
+            if n.name.startswith(HEAD_PREFIX) and n.op_type != "Conv"]
+
+
+def tag_model(path, value):
+    model = onnx.load(str(path))
+    for prop in list(model.metadata_props):
+        if prop.key == "quantization":
+            model.metadata_props.remove(prop)
+    entry = model.metadata_props.add()
+    entry.key, entry.value = "quantization", value
+    onnx.save(model, str(path))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="YOLOv8 ONNX INT8 quantization")
+    parser.add_argument("--model", required=True, help="FP32 ONNX model from convert_model.py")
+    parser.add_argument("--mode", choices=["dynamic", "static"], default="static")
+    parser.add_argument("--video", help="Calibration video (static mode)")
+    parser.add_argument("--calib-frames", type=int, default=200,
+                        help="Frames sampled from the video for calibration")
+    parser.add_argument("--calib-method", choices=["minmax", "entropy", "percentile"], default="minmax")
+    parser.add_argument("--per-channel", action=argparse.BooleanOptionalAction, default=True,
+                        help="Per-channel weight scales (more accurate convolutions)")
+    parser.add_argument("--quantize-head", action="store_true",
+                        help="Also quantize the detection head's decode (its Convs are always quantized)")
+    parser.add_argument("--output", default=None,
+                        help="Output path (default: <model>_int8_<mode>.onnx)")
+    args = parser.parse_args()
+
+    try:
+        from onnxruntime.quantization import (CalibrationDataReader, CalibrationMethod, QuantFormat,
+                                              QuantType, quantize_dynamic, quantize_static)
+        from onnxruntime.quantization.shape_inference import quant_pre_process
+    except ImportError:
+        raise SystemExit("onnxruntime not installed. Run: pip install onnxruntime onnx")
+
+    model_path = Path(args.model)
+    if not model_path.exists():
+        raise FileNotFoundError(f"Model {model_path} not found!")
+    output_path = Path(args.output or model_path.with_name(f"{model_path.stem}_int8_{args.mode}.onnx"))
+
+    #shape inference and constant folding make more nodes quantizable
+    prepared = output_path.with_name(output_path.stem + "_prep.onnx")
+    print(f"[INFO] Preparing {model_path} for quantization ...")
+    quant_pre_process(str(model_path), str(prepared), skip_symbolic_shape=True)
+
+    exclude = [] if args.quantize_head else head_nodes_to_exclude(prepared)
+    if exclude:
+        print(f"[INFO] Keeping {len(exclude)} detection-head nodes in float")
+
+    try:
+        if args.mode == "dynamic":
+            print(f"[INFO] Dynamic INT8 quantization -> {output_path}")
+            quantize_dynamic(str(prepared), str(output_path), weight_type=QuantType.QInt8,
+                             per_channel=args.per_channel, nodes_to_exclude=exclude)
+            tag = "int8-dynamic"
+        else:
+            if not args.video:
+                raise SystemExit("--video is required for static quantization")
+            input_name, width, height = input_info(prepared)
+            frames = sample_frames(args.video, args.calib_frames)
+            print(f"[INFO] Calibrating on {len(frames)} frames from {args.video} ({args.calib_method})")
+
+            class VideoReader(CalibrationDataReader):
+                def __init__(self):
+                    self.blobs = iter(letterbox_blob(f, width, height) for f in frames)
+
+                def get_next(self):
+                    blob = next(self.blobs, None)
+                    return None if blob is None else {input_name: blob}
+
+            method = {"minmax": CalibrationMethod.MinMax,
+                      "entropy": CalibrationMethod.Entropy,
+                      "percentile": CalibrationMethod.Percentile}[args.calib_method]
+            print(f"[INFO] Static QDQ INT8 quantization -> {output_path}")
+            quantize_static(str(prepared), str(output_path), VideoReader(),
+                            quant_format=QuantFormat.QDQ, per_channel=args.per_channel,
+                            activation_type=QuantType.QUInt8, weight_type=QuantType.QInt8,
+                            nodes_to_exclude=exclude, calibrate_method=method)
+            tag = "int8-static-qdq"
+    finally:
+        prepared.unlink(missing_ok=True)
+
+    tag_model(output_path, tag)
+    size_in = model_path.stat().st_size / 1e6
+    size_out = output_path.stat().st_size / 1e6
+    print(f"[DONE] {output_path} ({tag}): {size_in:.1f} MB -> {size_out:.1f} MB")
+
+
+if __name__ == "__main__":
+    main()
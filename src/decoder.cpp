@@ -0,0 +1,263 @@
+#include "../headers/decoder.h"
+#include <algorithm>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#include <immintrin.h>
+#define DECODER_HAVE_AVX2 1
+#endif
+
+namespace {
+
+//anchors scanned together by the scalar kernel; its per-anchor state stays on the stack
+const int kChunk = 64;
+
+// Maps one anchor's box to the source frame and appends it. Boxes squeezed to nothing
+// by the clamp are widened to one pixel; ones that stay empty are dropped.
+inline void emit(const float* box, size_t stride, int anchor, float score, int cls,
+                 const LetterboxMap& map, std::vector<Detection>& out) {
+    const float cx = box[anchor];
+    const float cy = box[stride + anchor];
+    const float w = box[2 * stride + anchor];
+    const float h = box[3 * stride + anchor];
+
+    const float width = static_cast<float>(map.image_size.width);
+    const float height = static_cast<float>(map.image_size.height);
+    float x1 = std::max(0.0f, std::min((cx - w / 2.0f - map.x_offset) / map.scale, width));
+    float y1 = std::max(0.0f, std::min((cy - h / 2.0f - map.y_offset) / map.scale, height));
+    float x2 = std::max(0.0f, std::min((cx + w / 2.0f - map.x_offset) / map.scale, width));
+    float y2 = std::max(0.0f, std::min((cy + h / 2.0f - map.y_offset) / map.scale, height));
+
+    if (y2 <= y1) y2 = y1 + 1.0f;
+    if (x2 <= x1) x2 = x1 + 1.0f;
+    if (x2 <= x1 || y2 <= y1) return;
+
+    out.push_back({cv::Rect2f(cv::Point2f(x1, y1), cv::Point2f(x2, y2)), score, cls});
+}
+
+// Class scan over `count` anchors starting at `first`: one pass per class plane, so
+// every load is contiguous and the inner loop vectorizes. Only the planes listed in
+// `classes` (ascending) are read. Like the row decoder, the first class with the
+// highest score wins and scores of 0 or less never do.
+void scanScalar(const float* scores, size_t stride, const std::vector<int>& classes, int first,
+                int count, float* best, int* cls) {
+    std::fill(best, best + count, 0.0f);
+    std::fill(cls, cls + count, -1);
+    for (int c : classes) {
+        const float* plane = scores + c * stride + first;
+        for (int i = 0; i < count; ++i) {
+            if (plane[i] > best[i]) {
+                best[i] = plane[i];
+                cls[i] = c;
+            }
+        }
+    }
+}
+
+void decodeScalar(const float* base, size_t stride, const std::vector<int>& classes, int anchors,
+                  float conf_threshold, const LetterboxMap& map, std::vector<Detection>& out) {
+    float best[kChunk];
+    int cls[kChunk];
+    for (int first = 0; first < anchors; first += kChunk) {
+        const int count = std::min(kChunk, anchors - first);
+        scanScalar(base + 4 * stride, stride, classes, first, count, best, cls);
+        for (int i = 0; i < count; ++i) {
+            if (best[i] >= conf_threshold) emit(base, stride, first + i, best[i], cls[i], map, out);
+        }
+    }
+}
+
+#ifdef DECODER_HAVE_AVX2
+// 8 anchors per step: a running max and argmax are kept in registers across the class
+// planes, then a movemask picks the anchors that pass. The tail uses the scalar scan.
+__attribute__((target("avx2")))
+void decodeAvx2(const float* base, size_t stride, const std::vector<int>& classes, int anchors,
+                float conf_threshold, const LetterboxMap& map, std::vector<Detection>& out) {
+    const float* scores = base + 4 * stride;
+    const __m256 threshold = _mm256_set1_ps(conf_threshold);
+    alignas(32) float best[kChunk];
+    alignas(32) int cls[kChunk];
+
+    int a = 0;
+    for (; a + 8 <= anchors; a += 8) {
+        __m256 vbest = _mm256_setzero_ps();
+        __m256 vcls = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (int c : classes) {
+            const __m256 v = _mm256_loadu_ps(scores + c * stride + a);
+            const __m256 higher = _mm256_cmp_ps(v, vbest, _CMP_GT_OQ);
+            vbest = _mm256_blendv_ps(vbest, v, higher);
+            vcls = _mm256_blendv_ps(vcls, _mm256_castsi256_ps(_mm256_set1_epi32(c)), higher);
+        }
+        int pass = _mm256_movemask_ps(_mm256_cmp_ps(vbest, threshold, _CMP_GE_OQ));
+        if (!pass) continue;
+
+        _mm256_store_ps(best, vbest);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(cls), _mm256_castps_si256(vcls));
+        for (; pass; pass &= pass - 1) {
+            const int i = __builtin_ctz(pass);
+            emit(base, stride, a + i, best[i], cls[i], map, out);
+        }
+    }
+
+    const int count = anchors - a;
+    if (count > 0) {
+        scanScalar(scores, stride, classes, a, count, best, cls);
+        for (int i = 0; i < count; ++i) {
+            if (best[i] >= conf_threshold) emit(base, stride, a + i, best[i], cls[i], map, out);
+        }
+    }
+}
+#endif
+
+} // namespace
+
+int HeadLayout::anchorsFor(int input_width, int input_height) {
+    int anchors = 0;
+    for (int stride : {8, 16, 32}) {
+        anchors += ((input_width + stride - 1) / stride) * ((input_height + stride - 1) / stride);
+    }
+    return anchors;
+}
+
+bool HeadLayout::fromModel(const std::vector<int64_t>& output_dims, int input_width, int input_height,
+                           HeadLayout& layout) {
+    if (output_dims.size() != 3) {
+        return false;
+    }
+    //dynamic dims are reported as -1
+    const int64_t first = output_dims[1];
+    const int64_t second = output_dims[2];
+    const int64_t anchors = (input_width > 0 && input_height > 0) ? anchorsFor(input_width, input_height) : -1;
+
+    Order order;
+    if (second == anchors && first > 4) {
+        order = Order::ChannelMajor;
+    } else if (first == anchors && second > 4) {
+        order = Order::AnchorMajor;
+    } else if (first > 4 && (second <= 0 || first < second)) {
+        order = Order::ChannelMajor;
+    } else if (second > 4 && (first <= 0 || second < first)) {
+        order = Order::AnchorMajor;
+    } else {
+        return false;
+    }
+
+    const int64_t channels = (order == Order::ChannelMajor) ? first : second;
+    const int64_t anchor_dim = (order == Order::ChannelMajor) ? second : first;
+    layout.num_classes = static_cast<int>(channels - 4);
+    layout.order = order;
+    layout.num_anchors = anchor_dim > 0 ? static_cast<int>(anchor_dim) : 0;
+    return true;
+}
+
+std::string HeadLayout::describe() const {
+    const std::string anchors = num_anchors > 0 ? std::to_string(num_anchors) : "N";
+    const std::string channels_str = std::to_string(channels());
+    std::string out = std::to_string(num_classes) + (num_classes == 1 ? " class, " : " classes, ");
+    switch (order) {
+    case Order::ChannelMajor:
+        return out + "channel-major [" + channels_str + ", " + anchors + "]";
+    case Order::AnchorMajor:
+        return out + "anchor-major [" + anchors + ", " + channels_str + "]";
+    default:
+        return out + "either layout";
+    }
+}
+
+YoloDecoder::YoloDecoder(const HeadLayout& head)
+    : head_(head), use_simd_(simdAvailable()) {
+    setClasses({});
+}
+
+void YoloDecoder::setClasses(const std::vector<int>& classes) {
+    classes_.clear();
+    if (classes.empty()) {
+        for (int c = 0; c < head_.num_classes; ++c) classes_.push_back(c);
+        return;
+    }
+    for (int c : classes) {
+        if (c >= 0 && c < head_.num_classes) classes_.push_back(c);
+    }
+    std::sort(classes_.begin(), classes_.end());
+    classes_.erase(std::unique(classes_.begin(), classes_.end()), classes_.end());
+}
+
+bool YoloDecoder::simdAvailable() {
+#ifdef DECODER_HAVE_AVX2
+    static const bool available = __builtin_cpu_supports("avx2");
+    return available;
+#else
+    return false;
+#endif
+}
+
+void YoloDecoder::useSimd(bool enabled) {
+    use_simd_ = enabled && simdAvailable();
+}
+
+bool YoloDecoder::decode(const cv::Mat& predictions, const LetterboxMap& map, float conf_threshold,
+                         std::vector<Detection>& out) const {
+    if (predictions.empty() || predictions.type() != CV_32F || predictions.dims != 2) {
+        return false;
+    }
+
+    const int channels = head_.channels();
+    bool channel_major;
+    switch (head_.order) {
+    case HeadLayout::Order::ChannelMajor:
+        channel_major = true;
+        if (predictions.rows != channels) return false;
+        break;
+    case HeadLayout::Order::AnchorMajor:
+        channel_major = false;
+        if (predictions.cols != channels) return false;
+        break;
+    default:
+        //a head with as many anchors as channels is ambiguous; ONNX exports are channel-major
+        channel_major = predictions.rows == channels;
+        if (!channel_major && predictions.cols != channels) return false;
+        break;
+    }
+    //a class filter that matched no class of this head
+    if (classes_.empty()) {
+        return true;
+    }
+
+    if (channel_major) {
+        decodeChannelMajor(predictions, map, conf_threshold, out);
+    } else {
+        decodeAnchorMajor(predictions, map, conf_threshold, out);
+    }
+    return true;
+}
+
+void YoloDecoder::decodeChannelMajor(const cv::Mat& predictions, const LetterboxMap& map,
+                                     float conf_threshold, std::vector<Detection>& out) const {
+    const float* base = predictions.ptr<float>(0);
+    const size_t stride = predictions.step1();
+#ifdef DECODER_HAVE_AVX2
+    if (use_simd_) {
+        decodeAvx2(base, stride, classes_, predictions.cols, conf_threshold, map, out);
+        return;
+    }
+#endif
+    decodeScalar(base, stride, classes_, predictions.cols, conf_threshold, map, out);
+}
+
+void YoloDecoder::decodeAnchorMajor(const cv::Mat& predictions, const LetterboxMap& map,
+                                    float conf_threshold, std::vector<Detection>& out) const {
+    for (int i = 0; i < predictions.rows; ++i) {
+        const float* row = predictions.ptr<float>(i);
+
+        int best_class = -1;
+        float max_prob = 0.0f;
+        for (int c : classes_) {
+            if (row[4 + c] > max_prob) {
+                max_prob = row[4 + c];
+                best_class = c;
+            }
+        }
+
+        //the four box values are one apart in a row
+        if (max_prob >= conf_threshold) emit(row, 1, 0, max_prob, best_class, map, out);
+    }
+}
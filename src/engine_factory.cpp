@@ -0,0 +1,49 @@
+#include "../headers/engine_factory.h"
+#include <iostream>
+#include <stdexcept>
+
+EngineFactory::EngineFactory(const SessionConfig& config, bool global_thread_pools)
+    : config_(config), global_thread_pools_(global_thread_pools) {
+    if (global_thread_pools_) {
+        Ort::ThreadingOptions threading;
+        //zero keeps ORT's default of one intra-op thread per physical core
+        threading.SetGlobalIntraOpNumThreads(config_.intra_op_threads);
+        threading.SetGlobalInterOpNumThreads(config_.inter_op_threads);
+        threading.SetGlobalSpinControl(config_.allow_spinning ? 1 : 0);
+        env_ = std::make_shared<Ort::Env>(threading, ORT_LOGGING_LEVEL_WARNING, "EngineFactory");
+    } else {
+        env_ = std::make_shared<Ort::Env>(ORT_LOGGING_LEVEL_WARNING, "EngineFactory");
+    }
+
+    OrtPrepackedWeightsContainer* container = nullptr;
+    Ort::ThrowOnError(Ort::GetApi().CreatePrepackedWeightsContainer(&container));
+    prepacked_.reset(container, [](OrtPrepackedWeightsContainer* p) {
+        Ort::GetApi().ReleasePrepackedWeightsContainer(p);
+    });
+}
+
+namespace {
+
+//ORT refuses sessions without their own pools when the Env has no global ones
+bool envLacksGlobalPools(const std::string& load_error) {
+    return load_error.find("CreateEnvWithGlobalThreadPools") != std::string::npos;
+}
+
+} // namespace
+
+std::unique_ptr<InferEngine> EngineFactory::create(const std::string& model_path) {
+    auto engine = std::make_unique<InferEngine>(env_, prepacked_, global_thread_pools_);
+    bool loaded = engine->loadModel(model_path, config_);
+    if (!loaded && global_thread_pools_ && envLacksGlobalPools(engine->lastLoadError())) {
+        //the process Env predates this factory and was created without global pools
+        std::cerr << "EngineFactory: the ORT environment has no global thread pools; "
+                     "using per-session thread pools." << std::endl;
+        global_thread_pools_ = false;
+        engine = std::make_unique<InferEngine>(env_, prepacked_, false);
+        loaded = engine->loadModel(model_path, config_);
+    }
+    if (!loaded) {
+        throw std::runtime_error("Failed to load model: " + model_path);
+    }
+    return engine;
+}
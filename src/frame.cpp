@@ -3,16 +3,26 @@
 #include <thread>
 #include <atomic>
 #include <vector>
+#include <deque>
+#include <future>
+#include <chrono>
 #include <opencv2/opencv.hpp>
 #include <iomanip>
 // Include all the corrected and verified headers
 #include "../headers/infer_engine.h"
 #include "../headers/preprocess.h"
-#include "../headers/nms.h"
+#include "../headers/postprocess.h"
 #include "../headers/frame_queue.h"
+#include "../headers/frame_pool.h"
+#include "../headers/reorder_buffer.h"
+#include "../headers/metrics.h"
+#include "../headers/ready_gate.h"
 
 // The producer function reads frames from a video source and pushes them into a queue.
-void producer(FrameQueue& fq, const std::string& video_path, std::atomic<bool>& running) {
+// Frames are decoded into buffers recycled through a FramePool of pool_size entries.
+// The source is opened right away, but no frame is read before `ready` opens.
+void producer(FrameQueue& fq, const std::string& video_path, std::atomic<bool>& running,
+              size_t pool_size, Metrics& metrics, ReadyGate& ready) {
     cv::VideoCapture cap;
     if (video_path.empty()) {
         std::cerr << "Error: empty video path.\n";
@@ -26,130 +36,307 @@ void producer(FrameQueue& fq, const std::string& video_path, std::atomic<bool>&
         return;
     }
 
+    //opening the source overlaps with model loading; reading waits for warm engines
+    if (!ready.wait()) {
+        fq.close();
+        return;
+    }
+
+    //buffers are sized from the first decoded frame, which is read into a fresh Mat
+    FramePool pool(pool_size);
+    cv::Mat frame;
+    ThreadMetrics& tm = metrics.local();
+    size_t dropped = 0;
+
     while (running.load(std::memory_order_relaxed)) {
-        cv::Mat frame;
-        if (!cap.read(frame)) {
-            break;
+        frame = pool.acquire();
+        {
+            ScopedStageTimer timer(tm, Stage::Decode);
+            if (!cap.read(frame)) {
+                break;
+            }
+        }
+        tm.add(Counter::FramesDecoded);
+        if (!pool.matches(frame)) {
+            pool.reserve(frame.size(), frame.type());
         }
         if (!fq.push(frame)) {
             break;
         }
+        const size_t now_dropped = fq.droppedFrames();
+        tm.add(Counter::FramesDropped, now_dropped - dropped);
+        dropped = now_dropped;
     }
 
     fq.close();
     cap.release();
+    if (pool.misses() > 0) {
+        std::cerr << "Frame pool exhausted " << pool.misses() << " times; consider a larger pool.\n";
+    }
     std::cerr << "Exiting, queue closed.\n";
 }
 
-static inline cv::Mat rows_detections(const cv::Mat& preds) {
-    auto in_range = [](int x){ return x >= 10 && x <= 512; };
+// Writes one annotated frame to out_path, opening the writer on the first frame.
+// Called by the ReorderBuffer, so frames arrive one at a time and in order.
+void writeFrame(cv::VideoWriter& writer, const std::string& out_path, const cv::Mat& frame) {
+    const int fourcc = cv::VideoWriter::fourcc('m','p','4','v');
+    const double fps_fallback = 25.0;
+
+    if (frame.empty()) return;
+
+    if (!writer.isOpened()) {
+        if (!writer.open(out_path, fourcc, fps_fallback, frame.size(), true)) {
+            std::cerr << "ERROR: could not open writer for " << out_path << "\n";
+        } else {
+            std::cerr << "Writing annotated video to " << out_path << "\n";
+        }
+    }
+
+    if (writer.isOpened()) writer.write(frame);
+}
+
+// Decodes the predictions for one frame and draws its detections onto it. Frames with
+// unusable predictions are left untouched, so they are written raw.
+static void annotate(cv::Mat& frame, const cv::Mat& preds, const Preprocessor& pre,
+                     Postprocessor& post, ThreadMetrics& tm)
+{
+    if (preds.empty()) {
+        return;
+    }
+
+    ScopedStageTimer post_timer(tm, Stage::Postprocess);
+    //the head is decoded in the engine's [4 + C, N] layout; nothing is transposed
+    if (preds.type() != CV_32F) {
+        std::cerr << "warning: unexpected predictions shape (" << preds.rows << "x" << preds.cols << "); writing raw frame.\n";
+        return;
+    }
 
-    if (preds.empty()) return preds;
+    //map boxes back with the letterbox geometry the preprocessor actually used
+    const auto [scale, padding] = pre.getScaleAndPadding();
+    const std::vector<Detection>& dets = post.process(preds, frame.size(), scale, padding);
+    post_timer.stop();
 
-    const int r = preds.rows;
-    const int c = preds.cols;
+    tm.add(Counter::Detections, dets.size());
+    if (dets.empty()) {
+        return;
+    }
 
-    if (in_range(c) && r > c) return preds;
-    if (in_range(r) && c > r) return preds.t();
-    if (r <= 128 && c > r) return preds.t();
-    return preds;
+    //bounding boxes and labels on the frame
+    ScopedStageTimer timer(tm, Stage::Draw);
+    for (const auto& d : dets) {
+        cv::rectangle(frame, d.box, cv::Scalar(0, 255, 0), 2);
+
+        std::ostringstream oss;
+        oss << "class " << d.cls << " " << std::fixed << std::setprecision(2) << d.conf;
+
+        int baseline = 0;
+        cv::Size label_sz = cv::getTextSize(oss.str(), cv::FONT_HERSHEY_SIMPLEX, 0.5, 1, &baseline);
+        cv::Point tl((int)d.box.x, std::max(0, (int)d.box.y - label_sz.height - 4));
+        cv::Rect bg(tl.x, tl.y, label_sz.width + 6, label_sz.height + 6);
+        bg &= cv::Rect(0, 0, frame.cols, frame.rows);
+
+        cv::rectangle(frame, bg, cv::Scalar(0,255,0), cv::FILLED);
+        cv::putText(frame, oss.str(),cv::Point(bg.x + 3, bg.y + label_sz.height + 3),
+                    cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(0,0,0), 1, cv::LINE_AA);
+    }
 }
 
 // The consumer function takes frames from the queue and performs the full inference pipeline.
-void consumer(FrameQueue& fq, InferEngine& engine, std::atomic<bool>& running,
-              float conf_threshold, float nms_threshold)
+// Several consumers may share one queue; each hands its annotated frames to `out`
+// under the frame's sequence number so the video is written in the original order.
+// Stage latencies and frame counters are recorded into `metrics`.
+void consumer(FrameQueue& fq, InferEngine& engine, ReorderBuffer& out, Metrics& metrics,
+              std::atomic<bool>& running, const PostprocessConfig& post)
 {
     Preprocessor pre(engine.getInputWidth(), engine.getInputHeight());
-
-    cv::VideoWriter writer;
-    const std::string out_path = "output.mp4";
-    const int fourcc = cv::VideoWriter::fourcc('m','p','4','v');
-    const double fps_fallback = 25.0;
+    Postprocessor postprocessor(post, engine.head());
+    ThreadMetrics& tm = metrics.local();
 
     while (running.load(std::memory_order_relaxed) || !fq.empty()) {
         cv::Mat frame;
-        if (!fq.pop(frame)) break;
-        if (frame.empty()) continue;
-
-        if (!writer.isOpened()) {
-            if (!writer.open(out_path, fourcc, fps_fallback, frame.size(), true)) {
-                std::cerr << "ERROR: could not open writer for " << out_path << "\n";
-            } else {
-                std::cerr << "Writing annotated video to " << out_path << "\n";
-            }
+        uint64_t seq = 0;
+        {
+            ScopedStageTimer timer(tm, Stage::QueueWait);
+            if (!fq.pop(frame, seq)) break;
+        }
+        if (frame.empty()) {
+            out.submit(seq, frame);
+            continue;
         }
+        tm.add(Counter::FramesProcessed);
 
-        cv::Mat blob = pre.process(frame);
-        if (blob.empty()) {
-            std::cerr << "Preprocess returned empty blob so writing raw frame.\n";
-            if (writer.isOpened()) writer.write(frame);
+        //preprocess straight into the engine's input tensor
+        ScopedStageTimer pre_timer(tm, Stage::Preprocess);
+        const bool prepared = pre.processInto(frame, engine.inputData());
+        pre_timer.stop();
+        if (!prepared) {
+            std::cerr << "Preprocess failed so writing raw frame.\n";
+            out.submit(seq, frame);
             continue;
         }
 
         cv::Mat preds;
         try {
-            preds = engine.infer(blob);
-            //check the predictions size and type
-            std::cout << "Predictions size: " << preds.size() << ", type: " << preds.type() << std::endl;
-            if (preds.rows < preds.cols) {
-                preds = preds.t();
-            }
+            ScopedStageTimer timer(tm, Stage::Inference);
+            preds = engine.infer();
         } catch (const std::exception& ex) {
             std::cerr << "[Consumer] Inference error: " << ex.what() << " ; writing raw frame.\n";
-            if (writer.isOpened()) writer.write(frame);
+            out.submit(seq, frame);
             continue;
         }
 
-        if (preds.empty()) {
-            if (writer.isOpened()) writer.write(frame);
-            continue;
-        }
+        annotate(frame, preds, pre, postprocessor, tm);
+        out.submit(seq, frame);
+    }
 
-        cv::Mat shaped = rows_detections(preds);
+    std::cerr << "Exiting.\n";
+}
 
-        if (shaped.type() != CV_32F || shaped.cols < 6) {
-            std::cerr << "warning: unexpected predictions shape (" << shaped.rows << "x" << shaped.cols << "); writing raw frame.\n";
-            if (writer.isOpened()) writer.write(frame);
-            continue;
+// Same pipeline as consumer(), but takes up to batch_size frames at once and runs them
+// through the model in a single InferEngine::inferBatch call. A batch is cut short when
+// no further frame arrives within kBatchWait, so a slow source does not stall output.
+void batchConsumer(FrameQueue& fq, InferEngine& engine, ReorderBuffer& out, Metrics& metrics,
+                   std::atomic<bool>& running, const PostprocessConfig& post,
+                   size_t batch_size)
+{
+    const std::chrono::milliseconds kBatchWait(10);
+    const size_t frame_floats = 3 * static_cast<size_t>(engine.getInputWidth()) * engine.getInputHeight();
+
+    //one preprocessor per batch slot keeps each slot's padding and geometry cached
+    std::vector<Preprocessor> pres(batch_size, Preprocessor(engine.getInputWidth(), engine.getInputHeight()));
+    Postprocessor postprocessor(post, engine.head());
+    ThreadMetrics& tm = metrics.local();
+    float* batch_input = engine.batchInputData(batch_size);
+
+    std::vector<cv::Mat> frames;
+    std::vector<size_t> slot_of(batch_size);
+    while (running.load(std::memory_order_relaxed) || !fq.empty()) {
+        uint64_t first_seq = 0;
+        {
+            ScopedStageTimer timer(tm, Stage::QueueWait);
+            if (!fq.popBatch(frames, batch_size, kBatchWait, &first_seq)) break;
         }
+        if (frames.empty()) continue;
 
-        std::vector<Detection> dets = postprocess(shaped, frame.size(), conf_threshold, nms_threshold);
+        //pack usable frames into consecutive batch slots; the rest are written raw
+        size_t n = 0;
+        {
+            ScopedStageTimer timer(tm, Stage::Preprocess);
+            for (size_t i = 0; i < frames.size(); ++i) {
+                slot_of[i] = batch_size;
+                if (frames[i].empty()) continue;
+                tm.add(Counter::FramesProcessed);
+                if (pres[n].processInto(frames[i], batch_input + n * frame_floats)) {
+                    slot_of[i] = n++;
+                }
+            }
+        }
 
-        //check how many detections are found
-        std::cout << "Detections found: " << dets.size() << std::endl;
-        if (dets.empty()) {
-            std::cerr << "No detections found. Writing raw frame.\n";
-            if (writer.isOpened()) writer.write(frame);
-            continue;
+        std::vector<cv::Mat> preds;
+        try {
+            ScopedStageTimer timer(tm, Stage::Inference);
+            preds = engine.inferBatch(n);
+        } catch (const std::exception& ex) {
+            std::cerr << "[Consumer] Batch inference error: " << ex.what() << " ; writing raw frames.\n";
         }
 
-        //bounding boxes and labels on the frame
-        for (const auto& d : dets) {
-            std::cout << "Drawing bounding box: " << d.box << ", Confidence: " << d.conf << std::endl;
-            cv::rectangle(frame, d.box, cv::Scalar(0, 255, 0), 2);
+        for (size_t i = 0; i < frames.size(); ++i) {
+            const size_t slot = slot_of[i];
+            if (slot < preds.size()) {
+                annotate(frames[i], preds[slot], pres[slot], postprocessor, tm);
+            }
+            out.submit(first_seq + i, frames[i]);
+        }
+    }
+
+    std::cerr << "Exiting.\n";
+}
 
-            std::ostringstream oss;
-            oss << "class " << d.cls << " " << std::fixed << std::setprecision(2) << d.conf;
+// Same pipeline as consumer(), but with up to in_flight frames inside the engine at once:
+// frame N+1 is preprocessed and frame N-1 annotated while ORT still runs frame N.
+// Results are collected oldest first. When the queue runs dry everything in flight is
+// finished right away, so a live source never waits for the next frame to get output.
+void asyncConsumer(FrameQueue& fq, InferEngine& engine, ReorderBuffer& out, Metrics& metrics,
+                   std::atomic<bool>& running, const PostprocessConfig& post,
+                   size_t in_flight)
+{
+    using Clock = std::chrono::steady_clock;
+    struct Pending {
+        size_t slot;
+        uint64_t seq;
+        cv::Mat frame;
+        std::future<cv::Mat> result;
+        Clock::time_point submitted;
+    };
 
-            int baseline = 0;
-            cv::Size label_sz = cv::getTextSize(oss.str(), cv::FONT_HERSHEY_SIMPLEX, 0.5, 1, &baseline);
-            cv::Point tl((int)d.box.x, std::max(0, (int)d.box.y - label_sz.height - 4));
-            cv::Rect bg(tl.x, tl.y, label_sz.width + 6, label_sz.height + 6);
-            bg &= cv::Rect(0, 0, frame.cols, frame.rows);
+    engine.setAsyncSlots(in_flight);
+    std::vector<Preprocessor> pres(in_flight, Preprocessor(engine.getInputWidth(), engine.getInputHeight()));
+    Postprocessor postprocessor(post, engine.head());
+    //written by the completion callback before the future becomes ready
+    std::vector<Clock::time_point> finished(in_flight);
+    ThreadMetrics& tm = metrics.local();
 
-            cv::rectangle(frame, bg, cv::Scalar(0,255,0), cv::FILLED);
-            cv::putText(frame, oss.str(),cv::Point(bg.x + 3, bg.y + label_sz.height + 3),
-                        cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(0,0,0), 1, cv::LINE_AA);
+    std::deque<Pending> pending;
+    size_t next_slot = 0;  //slots are used round-robin, so the oldest request holds the next one
+
+    auto finish_oldest = [&] {
+        Pending p = std::move(pending.front());
+        pending.pop_front();
+        cv::Mat preds;
+        try {
+            preds = p.result.get();
+            tm.record(Stage::Inference, finished[p.slot] - p.submitted);
+        } catch (const std::exception& ex) {
+            std::cerr << "[Consumer] Inference error: " << ex.what() << " ; writing raw frame.\n";
         }
+        annotate(p.frame, preds, pres[p.slot], postprocessor, tm);
+        out.submit(p.seq, p.frame);
+    };
 
-        if (writer.isOpened()) writer.write(frame);
-    }
+    while (running.load(std::memory_order_relaxed) || !fq.empty()) {
+        if (fq.empty()) {
+            while (!pending.empty()) finish_oldest();
+        }
+
+        cv::Mat frame;
+        uint64_t seq = 0;
+        {
+            ScopedStageTimer timer(tm, Stage::QueueWait);
+            if (!fq.pop(frame, seq)) break;
+        }
+        if (frame.empty()) {
+            out.submit(seq, frame);
+            continue;
+        }
+        tm.add(Counter::FramesProcessed);
+
+        if (pending.size() == in_flight) {
+            finish_oldest();
+        }
+
+        const size_t slot = next_slot;
+        ScopedStageTimer pre_timer(tm, Stage::Preprocess);
+        const bool prepared = pres[slot].processInto(frame, engine.asyncInputData(slot));
+        pre_timer.stop();
+        if (!prepared) {
+            std::cerr << "Preprocess failed so writing raw frame.\n";
+            out.submit(seq, frame);
+            continue;
+        }
 
-    if (writer.isOpened()) {
-        writer.release();
-        std::cerr << "Finished writing " << out_path << "\n";
+        try {
+            //taken before submitting: the callback may run before inferAsync returns
+            const auto submitted = Clock::now();
+            auto result = engine.inferAsync(slot, [&finished](size_t s, const cv::Mat&) { finished[s] = Clock::now(); });
+            pending.push_back({slot, seq, std::move(frame), std::move(result), submitted});
+            next_slot = (next_slot + 1) % in_flight;
+        } catch (const std::exception& ex) {
+            std::cerr << "[Consumer] Inference error: " << ex.what() << " ; writing raw frame.\n";
+            out.submit(seq, frame);
+        }
     }
 
+    while (!pending.empty()) finish_oldest();
     std::cerr << "Exiting.\n";
 }
 
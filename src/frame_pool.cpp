@@ -0,0 +1,58 @@
+#include "../headers/frame_pool.h"
+
+FramePool::FramePool(size_t capacity) : capacity_(capacity) {}
+
+void FramePool::reserve(cv::Size size, int type) {
+    std::lock_guard<std::mutex> lock(mtx);
+    buffers.clear();
+    buffers.reserve(capacity_);
+    for (size_t i = 0; i < capacity_; ++i) {
+        buffers.emplace_back(size, type);
+    }
+    size_ = size;
+    type_ = type;
+    next_ = 0;
+}
+
+bool FramePool::matches(const cv::Mat& frame) const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return !buffers.empty() && frame.size() == size_ && frame.type() == type_;
+}
+
+bool FramePool::isFree(const cv::Mat& buffer) {
+    //refcount is shared with the consumer thread, so read it atomically
+    return buffer.u && CV_XADD(&buffer.u->refcount, 0) == 1;
+}
+
+cv::Mat FramePool::acquire() {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (buffers.empty()) {
+        return cv::Mat();
+    }
+
+    //frames are consumed in FIFO order, so the buffer after the last one handed out is usually the first to be free again
+    for (size_t n = 0; n < buffers.size(); ++n) {
+        size_t i = (next_ + n) % buffers.size();
+        if (isFree(buffers[i])) {
+            next_ = i + 1;
+            return buffers[i];
+        }
+    }
+
+    misses_++;
+    return cv::Mat();
+}
+
+size_t FramePool::available() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    size_t n = 0;
+    for (const auto& b : buffers) {
+        if (isFree(b)) n++;
+    }
+    return n;
+}
+
+size_t FramePool::misses() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return misses_;
+}
@@ -1,27 +1,137 @@
 #include "../headers/frame_queue.h"
 #include <iostream>
+#include <thread>
+#include <stdexcept>
+#include <algorithm>
 #include <opencv2/opencv.hpp>
 
-FrameQueue::FrameQueue(size_t max_size)
-    : max_size(max_size), closed(false) {}
+namespace {
+
+// Number of busy-wait rounds before a Spsc side parks on its condition variable.
+// At video frame rates the other side usually makes progress well within this window,
+// so the steady-state handoff never enters the kernel. On a single core spinning only
+// steals the time slice the other side needs, so it is disabled there.
+constexpr int kSpinIterations = 2048;
+
+int spinLimit() {
+    static const int limit = std::thread::hardware_concurrency() > 1 ? kSpinIterations : 0;
+    return limit;
+}
+
+inline void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+// Spin until ready() holds, then fall back to sleeping on cv. Before each sleep the
+// waiter raises `parked` and re-checks; the waker publishes its index update, issues a
+// seq_cst fence and only takes the mutex if it is the one to clear `parked`, so at most
+// one notify is paid per park and no wakeup can be lost. With a deadline the wait gives
+// up once it passes; the caller re-reads the indices either way.
+template <typename Pred>
+void spinThenPark(Pred ready, std::atomic<bool>& parked,
+                  std::mutex& mtx, std::condition_variable& cv,
+                  const std::chrono::steady_clock::time_point* deadline = nullptr) {
+    const int spins = spinLimit();
+    for (int i = 0; i < spins; ++i) {
+        if (ready()) return;
+        cpuRelax();
+    }
+
+    std::unique_lock<std::mutex> lock(mtx);
+    while (true) {
+        parked.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (ready()) break;
+        if (!deadline) {
+            cv.wait(lock);
+        } else if (cv.wait_until(lock, *deadline) == std::cv_status::timeout) {
+            break;
+        }
+    }
+    parked.store(false, std::memory_order_relaxed);
+}
+
+inline void wakeIfParked(std::atomic<bool>& parked,
+                         std::mutex& mtx, std::condition_variable& cv) {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (parked.load(std::memory_order_relaxed) && parked.exchange(false)) {
+        std::lock_guard<std::mutex> lock(mtx);
+        cv.notify_one();
+    }
+}
+
+} // namespace
+
+FrameQueue::FrameQueue(size_t max_size, QueueMode mode, OverflowPolicy policy)
+    : max_size(max_size), closed(false), mode_(mode), policy_(policy), ring_(max_size) {
+    if (mode_ == QueueMode::Spsc &&
+        (policy_ == OverflowPolicy::DropOldest || policy_ == OverflowPolicy::KeepLatest)) {
+        throw std::invalid_argument("FrameQueue: drop-oldest/keep-latest need QueueMode::Mutex");
+    }
+}
 
 FrameQueue::~FrameQueue() {
     close();
 }
 
 bool FrameQueue::push(const cv::Mat& frame) {
+    if (mode_ == QueueMode::Spsc) {
+        return pushSpsc(frame);
+    }
+
     std::unique_lock<std::mutex> lock(mtx);
 
     if (closed || max_size == 0) {
         return false;
     }
 
-    //wait if the queue is full
-    while (q.size() >= max_size) {
-        cv_push.wait(lock);  //wait until space is available in the queue
+    auto queued = [this] {
+        return tail_.load(std::memory_order_relaxed) - head_.load(std::memory_order_relaxed);
+    };
+    //evicted slots are released right away so pooled buffers can be reused
+    auto drop_oldest = [this] {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        ring_[head % max_size].release();
+        head_.store(head + 1, std::memory_order_relaxed);
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+    };
+
+    switch (policy_) {
+    case OverflowPolicy::Block:
+        //wait if the queue is full
+        while (queued() >= max_size && !closed) {
+            cv_push.wait(lock);  //wait until space is available in the queue
+        }
+        if (closed) {
+            return false;
+        }
+        break;
+    case OverflowPolicy::DropNewest:
+        if (queued() >= max_size) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+        break;
+    case OverflowPolicy::DropOldest:
+        if (queued() >= max_size) {
+            drop_oldest();
+        }
+        break;
+    case OverflowPolicy::KeepLatest:
+        while (queued() > 0) {
+            drop_oldest();
+        }
+        break;
     }
 
-    q.push(frame);
+    //other producers may have pushed while we waited, so read tail only now
+    const size_t tail = tail_.load(std::memory_order_relaxed);
+    ring_[tail % max_size] = frame;
+    tail_.store(tail + 1, std::memory_order_relaxed);
 
     //notify one of the waiting threads to pop
     cv_pop.notify_one();
@@ -30,31 +140,167 @@ bool FrameQueue::push(const cv::Mat& frame) {
 }
 
 bool FrameQueue::pop(cv::Mat& frame) {
+    uint64_t seq;
+    return pop(frame, seq);
+}
+
+bool FrameQueue::pop(cv::Mat& frame, uint64_t& seq) {
+    if (mode_ == QueueMode::Spsc) {
+        return popSpsc(frame, seq);
+    }
+
     std::unique_lock<std::mutex> lock(mtx);
 
-    while (q.empty() && !closed) {
+    auto is_empty = [this] {
+        return tail_.load(std::memory_order_relaxed) == head_.load(std::memory_order_relaxed);
+    };
+    while (is_empty() && !closed) {
         cv_pop.wait(lock);  //wait until a frame is pushed or the queue is closed
     }
 
-    if (q.empty() && closed) {
+    if (is_empty() && closed) {
         return false;
     }
 
-    frame = q.front();
-    q.pop();  
+    const size_t head = head_.load(std::memory_order_relaxed);
+
+    //move out so the slot does not keep the frame buffer alive
+    frame = std::move(ring_[head % max_size]);
+    head_.store(head + 1, std::memory_order_relaxed);
+    seq = popped_++;
 
     cv_push.notify_one();
     return true;
 }
 
+bool FrameQueue::popBatch(std::vector<cv::Mat>& out, size_t max_n,
+                          std::chrono::microseconds max_wait, uint64_t* first_seq) {
+    out.clear();
+    const auto deadline = std::chrono::steady_clock::now() + max_wait;
+    //a batch larger than the queue could never fill up
+    const size_t want = std::min(max_n, max_size);
+
+    if (mode_ == QueueMode::Spsc) {
+        return popBatchSpsc(out, max_n, want, deadline, first_seq);
+    }
+
+    std::unique_lock<std::mutex> lock(mtx);
+    auto queued = [this] {
+        return tail_.load(std::memory_order_relaxed) - head_.load(std::memory_order_relaxed);
+    };
+    cv_pop.wait_until(lock, deadline, [&] { return queued() >= want || closed; });
+
+    const size_t n = std::min(queued(), max_n);
+    if (n == 0) {
+        return !closed;
+    }
+
+    size_t head = head_.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < n; ++i, ++head) {
+        out.push_back(std::move(ring_[head % max_size]));
+    }
+    head_.store(head, std::memory_order_relaxed);
+    if (first_seq) *first_seq = popped_;
+    popped_ += n;
+
+    cv_push.notify_all();
+    return true;
+}
+
+bool FrameQueue::pushSpsc(const cv::Mat& frame) {
+    if (closed.load(std::memory_order_acquire) || max_size == 0) {
+        return false;
+    }
+
+    const size_t tail = tail_.load(std::memory_order_relaxed);
+    if (policy_ == OverflowPolicy::DropNewest &&
+        tail - head_.load(std::memory_order_acquire) >= max_size) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    auto has_space = [&] {
+        return tail - head_.load(std::memory_order_acquire) < max_size ||
+               closed.load(std::memory_order_acquire);
+    };
+    if (!has_space()) {
+        spinThenPark(has_space, producer_parked_, mtx, cv_push);
+    }
+    if (closed.load(std::memory_order_acquire)) {
+        return false;
+    }
+
+    ring_[tail % max_size] = frame;
+    tail_.store(tail + 1, std::memory_order_release);
+
+    wakeIfParked(consumer_parked_, mtx, cv_pop);
+    return true;
+}
+
+bool FrameQueue::popSpsc(cv::Mat& frame, uint64_t& seq) {
+    const size_t head = head_.load(std::memory_order_relaxed);
+    auto has_data = [&] {
+        return tail_.load(std::memory_order_acquire) != head ||
+               closed.load(std::memory_order_acquire);
+    };
+    if (!has_data()) {
+        spinThenPark(has_data, consumer_parked_, mtx, cv_pop);
+    }
+
+    //closed queues are still drained before pop reports false
+    if (tail_.load(std::memory_order_acquire) == head) {
+        return false;
+    }
+
+    //move out so the slot does not keep the frame buffer alive
+    frame = std::move(ring_[head % max_size]);
+    head_.store(head + 1, std::memory_order_release);
+    seq = popped_++;
+
+    wakeIfParked(producer_parked_, mtx, cv_push);
+    return true;
+}
+
+bool FrameQueue::popBatchSpsc(std::vector<cv::Mat>& out, size_t max_n, size_t want,
+                              std::chrono::steady_clock::time_point deadline, uint64_t* first_seq) {
+    size_t head = head_.load(std::memory_order_relaxed);
+    auto has_batch = [&] {
+        return tail_.load(std::memory_order_acquire) - head >= want ||
+               closed.load(std::memory_order_acquire);
+    };
+    if (!has_batch()) {
+        spinThenPark(has_batch, consumer_parked_, mtx, cv_pop, &deadline);
+    }
+
+    //read closed before tail: once it is seen set, every push is already visible
+    const bool was_closed = closed.load(std::memory_order_acquire);
+    const size_t n = std::min<size_t>(tail_.load(std::memory_order_acquire) - head, max_n);
+    if (n == 0) {
+        return !was_closed;
+    }
+
+    for (size_t i = 0; i < n; ++i, ++head) {
+        out.push_back(std::move(ring_[head % max_size]));
+    }
+    head_.store(head, std::memory_order_release);
+    if (first_seq) *first_seq = popped_;
+    popped_ += n;
+
+    wakeIfParked(producer_parked_, mtx, cv_push);
+    return true;
+}
+
 bool FrameQueue::empty() const {
-    std::lock_guard<std::mutex> lock(mtx);
-    return q.empty();
+    return size() == 0;
 }
 
 size_t FrameQueue::size() const {
+    if (mode_ == QueueMode::Spsc) {
+        const size_t head = head_.load(std::memory_order_acquire);
+        return tail_.load(std::memory_order_acquire) - head;
+    }
     std::lock_guard<std::mutex> lock(mtx);
-    return q.size();
+    return tail_.load(std::memory_order_relaxed) - head_.load(std::memory_order_relaxed);
 }
 
 void FrameQueue::close() {
@@ -67,6 +313,5 @@ void FrameQueue::close() {
 }
 
 bool FrameQueue::isClosed() const {
-    std::lock_guard<std::mutex> lock(mtx);
-    return closed;
+    return closed.load();
 }
@@ -1,95 +1,458 @@
 #include "infer_engine.h"
 #include <filesystem>
 #include <stdexcept>
+#include <algorithm>
 #include <iostream>
+#include <cstring>
+#include <fstream>
+#include <chrono>
+#include <thread>
 #include <cpu_provider_factory.h>
+#include <onnxruntime_session_options_config_keys.h>
+#include "model_cache.h"
+#include "model_file.h"
 
-InferEngine::InferEngine() : env_(ORT_LOGGING_LEVEL_WARNING, "InferEngine") {}
+InferEngine::InferEngine()
+    : env_(std::make_shared<Ort::Env>(ORT_LOGGING_LEVEL_WARNING, "InferEngine")) {}
 
-InferEngine::InferEngine(const std::string& model_path)
-    : env_(ORT_LOGGING_LEVEL_WARNING, "InferEngine") {
-    if (!loadModel(model_path)) {
+InferEngine::InferEngine(const std::string& model_path, const SessionConfig& config)
+    : env_(std::make_shared<Ort::Env>(ORT_LOGGING_LEVEL_WARNING, "InferEngine")) {
+    if (!loadModel(model_path, config)) {
         throw std::runtime_error("Failed to load model: " + model_path);
     }
 }
 
-InferEngine::~InferEngine() = default;
+InferEngine::InferEngine(std::shared_ptr<Ort::Env> env, std::shared_ptr<OrtPrepackedWeightsContainer> prepacked,
+                         bool global_thread_pools)
+    : env_(std::move(env)), prepacked_(std::move(prepacked)), global_thread_pools_(global_thread_pools) {}
 
-bool InferEngine::loadModel(const std::string& model_path) {
+namespace {
+
+//models quantized by other tools carry no metadata; their operator names are plain
+//strings in the protobuf, so a byte search finds them
+std::string scanForQuantizedOps(std::string_view bytes) {
+    for (const char* op : {"DequantizeLinear", "QLinearConv", "ConvInteger", "MatMulInteger"}) {
+        if (bytes.find(op) != std::string::npos) return "int8";
+    }
+    return "";
+}
+
+} // namespace
+
+// One in-flight request of inferAsync(). Slots are heap-allocated so their address can
+// be handed to ORT as the RunAsync user data.
+struct InferEngine::AsyncSlot {
+    InferEngine* engine = nullptr;
+    size_t index = 0;
+    bool busy = false;
+    //RunAsync reads the name arrays after it returns, so they live with the slot
+    const char* input_names[1] = {nullptr};
+    const char* output_names[1] = {nullptr};
+    cv::Mat input;
+    cv::Mat output;  //empty for dynamic output dims; ORT then allocates output_tensor
+    Ort::Value input_tensor{nullptr};
+    Ort::Value output_tensor{nullptr};
+    std::promise<cv::Mat> promise;
+    AsyncCallback on_done;
+};
+
+InferEngine::~InferEngine() {
+    waitForAsync();
+    {
+        std::lock_guard<std::mutex> lock(async_mtx_);
+        executor_stop_ = true;
+    }
+    async_cv_.notify_all();
+    if (executor_.joinable()) executor_.join();
+}
+
+bool InferEngine::loadModel(const std::string& model_path, const SessionConfig& config) {
     if (!std::filesystem::exists(model_path)) {
-        std::cerr << "Model file not found: " << model_path << std::endl;
+        load_error_ = "Model file not found: " + model_path;
+        std::cerr << load_error_ << std::endl;
+        return false;
+    }
+
+    Ort::SessionOptions session_options;
+    config.apply(session_options);
+    loaded_from_cache_ = false;
+
+    bool mapped = false;
+    std::shared_ptr<ModelFile> model_file;  //mapping the session loaded, reused by the quantization scan
+    auto open_session = [&](const std::string& path, Ort::SessionOptions& options) {
+        if (config.mmap_model) {
+            auto file = std::make_shared<ModelFile>();
+            std::string error;
+            if (file->map(path, error)) {
+                if (!createSession(file->data(), file->size(), options, true, file)) {
+                    return false;
+                }
+                mapped = true;
+                model_file = file;
+                return true;
+            }
+            std::cerr << "Could not map " << path << " (" << error << "); reading it instead." << std::endl;
+        }
+        return createSession(path, options);
+    };
+
+    const std::string cache_entry = config.optimized_model_dir.empty()
+        ? std::string() : model_cache::entryPath(config.optimized_model_dir, model_path, config);
+    //a failed cache hit is only the entry's fault if the raw model then loads with the
+    //same options; a session-options or Env error fails both and leaves the entry alone
+    bool cache_entry_failed = false;
+    if (!cache_entry.empty() && std::filesystem::exists(cache_entry)) {
+        //the cached graph is already optimized, so skip the optimizer entirely
+        Ort::SessionOptions cached_options;
+        config.apply(cached_options);
+        cached_options.SetGraphOptimizationLevel(ORT_DISABLE_ALL);
+        loaded_from_cache_ = open_session(cache_entry, cached_options);
+        cache_entry_failed = !loaded_from_cache_;
+    }
+
+    if (!loaded_from_cache_) {
+        //write under a private name and rename, so concurrent starts never read a partial entry
+        std::string cache_tmp;
+        if (!cache_entry.empty()) {
+            std::error_code ec;
+            std::filesystem::create_directories(config.optimized_model_dir, ec);
+            cache_tmp = cache_entry + ".tmp" +
+                std::to_string(std::chrono::steady_clock::now().time_since_epoch().count() ^
+                               std::hash<std::thread::id>{}(std::this_thread::get_id()));
+            //the cache is best-effort: ORT fails the session if it cannot save the model
+            const bool writable = !ec && std::ofstream(cache_tmp, std::ios::binary).good();
+            std::filesystem::remove(cache_tmp, ec);
+            if (writable) {
+                session_options.AddConfigEntry(kOrtSessionOptionsConfigSaveModelFormat, "ORT");
+                session_options.SetOptimizedModelFilePath(cache_tmp.c_str());
+            } else {
+                std::cerr << "Optimized-model cache directory " << config.optimized_model_dir
+                          << " is not writable; cache disabled." << std::endl;
+                cache_tmp.clear();
+            }
+        }
+        bool opened = open_session(model_path, session_options);
+        if (!opened && !cache_tmp.empty()) {
+            //saving the optimized model may be what failed; load once more without it
+            std::error_code ec;
+            std::filesystem::remove(cache_tmp, ec);
+            cache_tmp.clear();
+            std::cerr << "Could not save the optimized model to " << config.optimized_model_dir
+                      << "; cache disabled." << std::endl;
+            Ort::SessionOptions plain_options;
+            config.apply(plain_options);
+            opened = open_session(model_path, plain_options);
+        }
+        if (!opened) {
+            return false;
+        }
+        if (cache_entry_failed) {
+            std::cerr << "Replacing unreadable optimized-model cache entry: " << cache_entry << std::endl;
+        }
+        if (!cache_tmp.empty()) {
+            //the rename also replaces an unreadable entry
+            std::error_code ec;
+            std::filesystem::rename(cache_tmp, cache_entry, ec);
+            if (ec) {
+                std::cerr << "Could not store optimized model in " << config.optimized_model_dir << ": " << ec.message() << std::endl;
+                std::filesystem::remove(cache_tmp, ec);
+                if (cache_entry_failed) std::filesystem::remove(cache_entry, ec);
+            }
+        }
+    }
+    std::cout << "Model loaded successfully: " << model_path
+              << (loaded_from_cache_ ? " (optimized-model cache)" : "")
+              << (model_bytes_ ? " (mapped, weights in place)" : mapped ? " (mapped)" : "") << std::endl;
+
+    //the quantization scan reads the file the session loaded through a mapping, so it
+    //never copies the model and a cache hit does not touch the original .onnx; the
+    //cached graph keeps the quantized op names
+    if (!model_file) {
+        auto file = std::make_shared<ModelFile>();
+        std::string error;
+        if (file->map(loaded_from_cache_ ? cache_entry : model_path, error)) model_file = file;
+    }
+    const std::string_view bytes = model_file
+        ? std::string_view(static_cast<const char*>(model_file->data()), model_file->size()) : std::string_view();
+    return finishLoad(model_path, config, bytes);
+}
+
+bool InferEngine::loadModelFromBuffer(const void* data, size_t size, const SessionConfig& config,
+                                      bool bytes_outlive_engine) {
+    if (!data || size == 0) {
+        std::cerr << "Error: empty model buffer." << std::endl;
         return false;
     }
 
     Ort::SessionOptions session_options;
+    config.apply(session_options);
+    loaded_from_cache_ = false;
+    if (!createSession(data, size, session_options, bytes_outlive_engine, nullptr)) {
+        return false;
+    }
+    std::cout << "Model loaded successfully from a " << size << "-byte buffer" << std::endl;
+
+    return finishLoad("<buffer>", config, std::string_view(static_cast<const char*>(data), size));
+}
+
+bool InferEngine::finishLoad(const std::string& source, const SessionConfig& config, std::string_view bytes) {
+    if (!readModelInfo()) {
+        session_.reset();
+        model_bytes_.reset();
+        return false;
+    }
+    head_ = HeadLayout();
+    head_known_ = HeadLayout::fromModel(output_dims_, input_width_, input_height_, head_);
+
+    Ort::AllocatorWithDefaultOptions allocator;
+    auto tag = session_->GetModelMetadata().LookupCustomMetadataMapAllocated("quantization", allocator);
+    if (tag) {
+        quantization_ = tag.get();
+    } else {
+        quantization_ = scanForQuantizedOps(bytes);
+    }
+    if (!quantization_.empty() && config.graph_optimization == ORT_DISABLE_ALL && !loaded_from_cache_) {
+        std::cerr << "warning: " << source << " is quantized (" << quantization_ << ") but graph optimization "
+                  << "is disabled, so its QDQ pairs run unfused in float; use --opt-level basic or higher." << std::endl;
+    }
+
+    model_path_ = source;
+    config_ = config;
+    allocateIo();
+    warmUp(config.warmup_runs, config.warmup_batch);
+    return true;
+}
+
+void InferEngine::warmUp(int runs, int max_batch) {
+    if (!session_ || runs <= 0) return;
+    using clock = std::chrono::steady_clock;
+    auto ms_since = [](clock::time_point t) {
+        return std::chrono::duration<double, std::milli>(clock::now() - t).count();
+    };
 
+    //the letterbox padding colour; the values do not matter to ORT, only the shapes
+    const float grey = 114.0f / 255.0f;
+    const auto start = clock::now();
+    double first_ms = 0, last_ms = 0;
+    std::fill_n(inputData(), input_blob_.total(), grey);
+    for (int r = 0; r < runs; ++r) {
+        const auto t = clock::now();
+        infer();
+        last_ms = ms_since(t);
+        if (r == 0) first_ms = last_ms;
+    }
+
+    const size_t batch = static_cast<size_t>(std::max(1, max_batch));
+    if (batch > 1) {
+        std::fill_n(batchInputData(batch), batch * input_blob_.total(), grey);
+        //a batch-1 model runs batches frame by frame, which infer() already covered
+        if (supportsBatch()) {
+            for (size_t n = 1; n <= batch; ++n) {
+                for (int r = 0; r < runs; ++r) inferBatch(n);
+            }
+        }
+    }
+
+    std::cout << "Warm-up: " << runs << " run(s)";
+    if (batch > 1 && supportsBatch()) std::cout << " per batch size 1-" << batch;
+    std::cout << " in " << static_cast<int>(ms_since(start)) << " ms; first inference "
+              << first_ms << " ms, last " << last_ms << " ms" << std::endl;
+}
+
+bool InferEngine::createSession(const std::string& path, Ort::SessionOptions& options) {
     try {
-        session_ = std::make_unique<Ort::Session>(env_, model_path.c_str(), session_options);
-        std::cout << "Model loaded successfully: " << model_path << std::endl;
+        if (global_thread_pools_) {
+            options.DisablePerSessionThreads();
+        }
+        session_ = prepacked_
+            ? std::make_shared<Ort::Session>(*env_, path.c_str(), options, prepacked_.get())
+            : std::make_shared<Ort::Session>(*env_, path.c_str(), options);
+        model_bytes_.reset();
     } catch (const std::exception& e) {
+        load_error_ = e.what();
         std::cerr << "Error loading model: " << e.what() << std::endl;
+        session_.reset();
+        model_bytes_.reset();
+        return false;
+    }
+    load_error_.clear();
+    return true;
+}
+
+bool InferEngine::createSession(const void* data, size_t size, Ort::SessionOptions& options, bool bytes_persist,
+                                std::shared_ptr<const ModelFile> owner) {
+    //ORT format bytes that stay valid back the session in place, initializers included;
+    //ONNX protobuf is always parsed into ORT's own tensors, so its bytes can go afterwards
+    const bool in_place = bytes_persist && ModelFile::isOrtFormat(data, size);
+    try {
+        if (in_place) {
+            options.AddConfigEntry(kOrtSessionOptionsConfigUseORTModelBytesDirectly, "1");
+            options.AddConfigEntry(kOrtSessionOptionsConfigUseORTModelBytesForInitializers, "1");
+        }
+        if (global_thread_pools_) {
+            options.DisablePerSessionThreads();
+        }
+        //replace the session before the bytes, the old session may still read from them
+        session_ = prepacked_
+            ? std::make_shared<Ort::Session>(*env_, data, size, options, prepacked_.get())
+            : std::make_shared<Ort::Session>(*env_, data, size, options);
+        model_bytes_ = in_place ? std::move(owner) : nullptr;
+    } catch (const std::exception& e) {
+        load_error_ = e.what();
+        std::cerr << "Error loading model: " << e.what() << std::endl;
+        session_.reset();
+        model_bytes_.reset();
+        return false;
+    }
+    load_error_.clear();
+    return true;
+}
+
+bool InferEngine::readModelInfo() {
+    if (session_->GetInputCount() < 1 || session_->GetOutputCount() < 1) {
+        std::cerr << "Error: model has no inputs or outputs." << std::endl;
         return false;
     }
 
+    Ort::AllocatorWithDefaultOptions allocator;
+    input_name_ = session_->GetInputNameAllocated(0, allocator).get();
+    output_name_ = session_->GetOutputNameAllocated(0, allocator).get();
+
+    //the shape infos are views into the type infos, which must outlive them
+    Ort::TypeInfo input_type = session_->GetInputTypeInfo(0);
+    Ort::TypeInfo output_type = session_->GetOutputTypeInfo(0);
+    auto input_info = input_type.GetTensorTypeAndShapeInfo();
+    auto output_info = output_type.GetTensorTypeAndShapeInfo();
+    input_dims_ = input_info.GetShape();
+    output_dims_ = output_info.GetShape();
+
+    if (input_info.GetElementType() != ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT ||
+        output_info.GetElementType() != ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT) {
+        std::cerr << "Error: model input and output must be float tensors." << std::endl;
+        return false;
+    }
+
+    //expecting an image input [N, 3, H, W]
+    if (input_dims_.size() != 4 || (input_dims_[1] != 3 && input_dims_[1] > 0)) {
+        std::cerr << "Error: expected a [N, 3, H, W] model input." << std::endl;
+        return false;
+    }
+    if (input_dims_[2] > 0 && input_dims_[3] > 0) {
+        input_height_ = static_cast<int>(input_dims_[2]);
+        input_width_ = static_cast<int>(input_dims_[3]);
+    } else {
+        std::cerr << "Model input resolution is dynamic; using " << input_width_ << "x" << input_height_ << "." << std::endl;
+    }
     return true;
 }
 
+bool InferEngine::hasStaticOutput() const {
+    return output_dims_.size() == 3 && output_dims_[0] <= 1 && output_dims_[1] > 0 && output_dims_[2] > 0;
+}
+
+void InferEngine::allocateIo() {
+    std::vector<int> blob_shape = {1, 3, input_height_, input_width_};
+    input_blob_.create(4, blob_shape.data(), CV_32F);
+
+    std::vector<int64_t> input_shape = {1, 3, input_height_, input_width_};
+    memory_info_ = Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeCPU);
+    input_tensor_ = Ort::Value::CreateTensor<float>(
+        memory_info_,
+        input_blob_.ptr<float>(),
+        input_blob_.total(),
+        input_shape.data(),
+        input_shape.size()
+    );
+
+    io_binding_ = Ort::IoBinding(*session_);
+    io_binding_.BindInput(input_name_.c_str(), input_tensor_);
+
+    //a static [1, C, N] output (or [-1, C, N] run with one frame) is written straight
+    //into output_blob_
+    if (hasStaticOutput()) {
+        std::vector<int64_t> output_shape = {1, output_dims_[1], output_dims_[2]};
+        output_blob_.create(static_cast<int>(output_dims_[1]), static_cast<int>(output_dims_[2]), CV_32F);
+        output_tensor_ = Ort::Value::CreateTensor<float>(
+            memory_info_,
+            output_blob_.ptr<float>(),
+            output_blob_.total(),
+            output_shape.data(),
+            output_shape.size()
+        );
+        io_binding_.BindOutput(output_name_.c_str(), output_tensor_);
+    } else {
+        output_blob_.release();
+        io_binding_.BindOutput(output_name_.c_str(), memory_info_);
+    }
+}
+
+std::unique_ptr<InferEngine> InferEngine::withSharedSession() const {
+    auto engine = std::make_unique<InferEngine>();
+    engine->env_ = env_;
+    engine->prepacked_ = prepacked_;
+    engine->global_thread_pools_ = global_thread_pools_;
+    engine->model_bytes_ = model_bytes_;
+    engine->session_ = session_;
+    engine->model_path_ = model_path_;
+    engine->config_ = config_;
+    engine->loaded_from_cache_ = loaded_from_cache_;
+    engine->quantization_ = quantization_;
+    engine->input_width_ = input_width_;
+    engine->input_height_ = input_height_;
+    engine->input_name_ = input_name_;
+    engine->output_name_ = output_name_;
+    engine->input_dims_ = input_dims_;
+    engine->output_dims_ = output_dims_;
+    engine->head_ = head_;
+    engine->head_known_ = head_known_;
+    engine->allocateIo();
+    return engine;
+}
+
 cv::Mat InferEngine::infer(const cv::Mat& input_blob) {
     if (input_blob.empty()) {
         std::cerr << "Error: Empty blob received for inference." << std::endl;
         return cv::Mat();
     }
 
-    //ensuring input is a 4D blob [1, 3, 640, 640] 
-    cv::Mat blob_4d;
-    if (input_blob.dims == 2 && input_blob.cols == 1 &&
-        input_blob.total() == 1 * 3 * 640 * 640) {
-        int shape[] = {1, 3, 640, 640};
-        blob_4d = input_blob.reshape(1, 4, shape);
-    } else if (input_blob.dims == 4) {
-        blob_4d = input_blob;
-    } else {
-        std::cerr << "Error: Expected 4D blob [1, 3, 640, 640], got "
+    if (!session_) {
+        throw std::runtime_error("InferEngine::infer called before a model was loaded");
+    }
+
+    //ensuring input is a [1, 3, H, W] blob (or the same data as a single column)
+    const size_t expected = input_blob_.total();
+    const bool is_4d = input_blob.dims == 4 && input_blob.total() == expected;
+    const bool is_column = input_blob.dims == 2 && input_blob.cols == 1 && input_blob.total() == expected;
+    if (!is_4d && !is_column) {
+        std::cerr << "Error: Expected 4D blob [1, 3, " << input_height_ << ", " << input_width_ << "], got "
                   << input_blob.dims << "D tensor" << std::endl;
         return cv::Mat();
     }
 
-    if (!blob_4d.isContinuous()) {
-        blob_4d = blob_4d.clone(); 
+    //blobs written by Preprocessor::processInto already live in the input buffer
+    if (input_blob.data != input_blob_.data) {
+        const cv::Mat src = input_blob.isContinuous() ? input_blob : input_blob.clone();
+        std::memcpy(input_blob_.data, src.data, expected * sizeof(float));
     }
 
-    //creating ONNX input tensor from the blob
-    std::vector<int64_t> input_shape = {1, 3, 640, 640};
-    Ort::MemoryInfo memory_info = Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeCPU);
+    return infer();
+}
 
-    Ort::Value input_tensor = Ort::Value::CreateTensor<float>(
-        memory_info,
-        blob_4d.ptr<float>(),
-        blob_4d.total(),
-        input_shape.data(),
-        input_shape.size()
-    );
+cv::Mat InferEngine::infer() {
+    if (!session_) {
+        throw std::runtime_error("InferEngine::infer called before a model was loaded");
+    }
 
-    //get ONNX input/output names
-    Ort::AllocatorWithDefaultOptions allocator;
-    auto input_name_ptr = session_->GetInputNameAllocated(0, allocator);
-    auto output_name_ptr = session_->GetOutputNameAllocated(0, allocator);
-    const char* input_names[] = { input_name_ptr.get() };
-    const char* output_names[] = { output_name_ptr.get() };
-
-
-    //run inference 
-    std::vector<Ort::Value> output_tensors = session_->Run(
-        Ort::RunOptions{},
-        input_names,
-        &input_tensor,
-        1,
-        output_names,
-        1
-    );
+    //input and output were bound at load time
+    session_->Run(run_options_, io_binding_);
 
+    if (!output_blob_.empty()) {
+        return output_blob_;
+    }
 
-    Ort::Value& output_tensor = output_tensors.front();
+    //dynamic output dims: ORT allocated the output, keep it alive behind the view
+    dynamic_outputs_ = io_binding_.GetOutputValues();
+    Ort::Value& output_tensor = dynamic_outputs_.front();
 
     auto output_shape_info = output_tensor.GetTensorTypeAndShapeInfo();
     auto output_shape = output_shape_info.GetShape();
@@ -100,13 +463,257 @@ cv::Mat InferEngine::infer(const cv::Mat& input_blob) {
         return cv::Mat();
     }
 
-    const size_t num_features = output_shape[1]; 
-    const size_t num_predictions = output_shape[2];
+    const int num_features = static_cast<int>(output_shape[1]); 
+    const int num_predictions = static_cast<int>(output_shape[2]);
 
     float* output_data = output_tensor.GetTensorMutableData<float>();
-    cv::Mat output_as_mat(1, num_features * num_predictions, CV_32F, output_data);
- 
-    cv::Mat predictions = output_as_mat.reshape(1, num_features).clone();
-    
+    return cv::Mat(num_features, num_predictions, CV_32F, output_data);
+}
+
+float* InferEngine::batchInputData(size_t n) {
+    if (n > batch_capacity_) {
+        std::vector<int> blob_shape = {static_cast<int>(n), 3, input_height_, input_width_};
+        batch_input_.create(4, blob_shape.data(), CV_32F);
+        batch_capacity_ = n;
+        batch_bound_ = 0;  //the buffer moved, bind again before the next run
+    }
+    return batch_input_.ptr<float>();
+}
+
+void InferEngine::bindBatch(size_t n) {
+    const size_t frame_floats = input_blob_.total();
+    std::vector<int64_t> input_shape = {static_cast<int64_t>(n), 3, input_height_, input_width_};
+    batch_input_tensor_ = Ort::Value::CreateTensor<float>(
+        memory_info_,
+        batch_input_.ptr<float>(),
+        n * frame_floats,
+        input_shape.data(),
+        input_shape.size()
+    );
+
+    batch_binding_ = Ort::IoBinding(*session_);
+    batch_binding_.BindInput(input_name_.c_str(), batch_input_tensor_);
+
+    const bool static_output = output_dims_.size() == 3 && output_dims_[1] > 0 && output_dims_[2] > 0;
+    if (static_output) {
+        const int rows = static_cast<int>(n * output_dims_[1]);
+        if (batch_output_.rows < rows) {
+            batch_output_.create(rows, static_cast<int>(output_dims_[2]), CV_32F);
+        }
+        std::vector<int64_t> output_shape = {static_cast<int64_t>(n), output_dims_[1], output_dims_[2]};
+        batch_output_tensor_ = Ort::Value::CreateTensor<float>(
+            memory_info_,
+            batch_output_.ptr<float>(),
+            n * output_dims_[1] * output_dims_[2],
+            output_shape.data(),
+            output_shape.size()
+        );
+        batch_binding_.BindOutput(output_name_.c_str(), batch_output_tensor_);
+    } else {
+        batch_output_.release();
+        batch_binding_.BindOutput(output_name_.c_str(), memory_info_);
+    }
+    batch_bound_ = n;
+}
+
+std::vector<cv::Mat> InferEngine::inferBatch(size_t n) {
+    std::vector<cv::Mat> predictions;
+    if (n == 0) return predictions;
+    if (!session_) {
+        throw std::runtime_error("InferEngine::inferBatch called before a model was loaded");
+    }
+    batchInputData(n);
+    predictions.reserve(n);
+
+    const size_t frame_floats = input_blob_.total();
+    if (!supportsBatch()) {
+        //fixed batch of 1: one Run per frame, copying each result out of the shared view
+        for (size_t i = 0; i < n; ++i) {
+            std::memcpy(input_blob_.data, batch_input_.ptr<float>() + i * frame_floats, frame_floats * sizeof(float));
+            predictions.push_back(infer().clone());
+        }
+        return predictions;
+    }
+
+    if (batch_bound_ != n) {
+        bindBatch(n);
+    }
+    session_->Run(run_options_, batch_binding_);
+
+    if (!batch_output_.empty()) {
+        const int c = static_cast<int>(output_dims_[1]);
+        for (size_t i = 0; i < n; ++i) {
+            predictions.push_back(batch_output_.rowRange(static_cast<int>(i) * c, static_cast<int>(i + 1) * c));
+        }
+        return predictions;
+    }
+
+    //dynamic output dims: ORT allocated the output, keep it alive behind the views
+    batch_outputs_ = batch_binding_.GetOutputValues();
+    auto output_shape = batch_outputs_.front().GetTensorTypeAndShapeInfo().GetShape();
+    if (output_shape.size() != 3 || output_shape[0] != static_cast<int64_t>(n)) {
+        std::cerr << "Error: Unexpected batch output shape. Expected [" << n << ", C, N]." << std::endl;
+        return predictions;
+    }
+    const int c = static_cast<int>(output_shape[1]);
+    const int p = static_cast<int>(output_shape[2]);
+    float* data = batch_outputs_.front().GetTensorMutableData<float>();
+    for (size_t i = 0; i < n; ++i) {
+        predictions.emplace_back(c, p, CV_32F, data + i * c * p);
+    }
     return predictions;
-}
\ No newline at end of file
+}
+
+std::vector<cv::Mat> InferEngine::inferBatch(const std::vector<cv::Mat>& blobs) {
+    const size_t frame_floats = 3 * static_cast<size_t>(input_height_) * input_width_;
+    for (const auto& blob : blobs) {
+        if (blob.empty() || blob.type() != CV_32F || blob.total() != frame_floats) {
+            std::cerr << "Error: inferBatch expects [1, 3, " << input_height_ << ", " << input_width_
+                      << "] float blobs." << std::endl;
+            return {};
+        }
+    }
+
+    float* dst = batchInputData(blobs.size());
+    for (size_t i = 0; i < blobs.size(); ++i) {
+        const cv::Mat src = blobs[i].isContinuous() ? blobs[i] : blobs[i].clone();
+        std::memcpy(dst + i * frame_floats, src.data, frame_floats * sizeof(float));
+    }
+    return inferBatch(blobs.size());
+}
+
+void InferEngine::waitForAsync() {
+    std::unique_lock<std::mutex> lock(async_mtx_);
+    async_cv_.wait(lock, [this] { return async_pending_ == 0; });
+}
+
+void InferEngine::setAsyncSlots(size_t k) {
+    waitForAsync();
+    async_slots_.clear();
+
+    std::vector<int> blob_shape = {1, 3, input_height_, input_width_};
+    std::vector<int64_t> input_shape = {1, 3, input_height_, input_width_};
+    for (size_t i = 0; i < k; ++i) {
+        auto slot = std::make_unique<AsyncSlot>();
+        slot->engine = this;
+        slot->index = i;
+        slot->input_names[0] = input_name_.c_str();
+        slot->output_names[0] = output_name_.c_str();
+        slot->input.create(4, blob_shape.data(), CV_32F);
+        slot->input_tensor = Ort::Value::CreateTensor<float>(
+            memory_info_, slot->input.ptr<float>(), slot->input.total(), input_shape.data(), input_shape.size());
+        if (hasStaticOutput()) {
+            std::vector<int64_t> output_shape = {1, output_dims_[1], output_dims_[2]};
+            slot->output.create(static_cast<int>(output_dims_[1]), static_cast<int>(output_dims_[2]), CV_32F);
+            slot->output_tensor = Ort::Value::CreateTensor<float>(
+                memory_info_, slot->output.ptr<float>(), slot->output.total(), output_shape.data(), output_shape.size());
+        }
+        async_slots_.push_back(std::move(slot));
+    }
+}
+
+float* InferEngine::asyncInputData(size_t slot) {
+    if (slot >= async_slots_.size()) {
+        throw std::out_of_range("InferEngine::asyncInputData: slot " + std::to_string(slot) + " not prepared");
+    }
+    return async_slots_[slot]->input.ptr<float>();
+}
+
+std::future<cv::Mat> InferEngine::inferAsync(size_t index, AsyncCallback on_done) {
+    if (!session_) {
+        throw std::runtime_error("InferEngine::inferAsync called before a model was loaded");
+    }
+    if (index >= async_slots_.size()) {
+        throw std::out_of_range("InferEngine::inferAsync: slot " + std::to_string(index) + " not prepared");
+    }
+
+    AsyncSlot& slot = *async_slots_[index];
+    {
+        std::unique_lock<std::mutex> lock(async_mtx_);
+        async_cv_.wait(lock, [&] { return !slot.busy; });
+        slot.busy = true;
+        ++async_pending_;
+    }
+    slot.promise = std::promise<cv::Mat>();
+    std::future<cv::Mat> result = slot.promise.get_future();
+    slot.on_done = std::move(on_done);
+    if (slot.output.empty()) {
+        slot.output_tensor = Ort::Value(nullptr);  //let ORT allocate the dynamic output
+    }
+
+    if (!use_executor_) {
+        try {
+            session_->RunAsync(run_options_, slot.input_names, &slot.input_tensor, 1,
+                               slot.output_names, &slot.output_tensor, 1, &InferEngine::onRunAsyncDone, &slot);
+            return result;
+        } catch (const Ort::Exception& e) {
+            std::cerr << "RunAsync unavailable (" << e.what() << "); running requests on an executor thread." << std::endl;
+            use_executor_ = true;
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(async_mtx_);
+        if (!executor_.joinable()) {
+            executor_ = std::thread(&InferEngine::executorLoop, this);
+        }
+        executor_jobs_.push_back(&slot);
+    }
+    async_cv_.notify_all();
+    return result;
+}
+
+void InferEngine::onRunAsyncDone(void* user_data, OrtValue**, size_t, OrtStatusPtr status_ptr) {
+    auto* slot = static_cast<AsyncSlot*>(user_data);
+    Ort::Status status(status_ptr);  //takes ownership of the status
+    slot->engine->completeAsync(*slot, status.IsOK() ? std::string() : status.GetErrorMessage());
+}
+
+void InferEngine::executorLoop() {
+    std::unique_lock<std::mutex> lock(async_mtx_);
+    while (true) {
+        async_cv_.wait(lock, [this] { return executor_stop_ || !executor_jobs_.empty(); });
+        if (executor_jobs_.empty()) return;
+        AsyncSlot* slot = executor_jobs_.front();
+        executor_jobs_.erase(executor_jobs_.begin());
+        lock.unlock();
+
+        std::string error;
+        try {
+            session_->Run(run_options_, slot->input_names, &slot->input_tensor, 1,
+                          slot->output_names, &slot->output_tensor, 1);
+        } catch (const std::exception& e) {
+            error = e.what();
+        }
+        completeAsync(*slot, error);
+        lock.lock();
+    }
+}
+
+void InferEngine::completeAsync(AsyncSlot& slot, const std::string& error) {
+    if (error.empty()) {
+        try {
+            cv::Mat predictions = slot.output;
+            if (predictions.empty()) {
+                auto shape = slot.output_tensor.GetTensorTypeAndShapeInfo().GetShape();
+                if (shape.size() != 3 || shape[0] != 1) {
+                    throw std::runtime_error("unexpected output tensor shape, expected [1, C, N]");
+                }
+                predictions = cv::Mat(static_cast<int>(shape[1]), static_cast<int>(shape[2]), CV_32F,
+                                      slot.output_tensor.GetTensorMutableData<float>());
+            }
+            if (slot.on_done) slot.on_done(slot.index, predictions);
+            slot.promise.set_value(predictions);
+        } catch (...) {
+            slot.promise.set_exception(std::current_exception());
+        }
+    } else {
+        slot.promise.set_exception(std::make_exception_ptr(std::runtime_error("inference failed: " + error)));
+    }
+
+    //the slot may be reused as soon as busy drops, so nothing below touches it
+    std::lock_guard<std::mutex> lock(async_mtx_);
+    slot.busy = false;
+    --async_pending_;
+    async_cv_.notify_all();
+}
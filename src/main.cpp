@@ -2,9 +2,21 @@
 #include <string>
 #include <thread>
 #include <atomic>
+#include <memory>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <chrono>
 #include <csignal>
+#include <algorithm>
 #include "infer_engine.h"
+#include "engine_factory.h"
 #include "frame_queue.h"
+#include "reorder_buffer.h"
+#include "metrics.h"
+#include "nms.h"
+#include "decoder.h"
+#include "ready_gate.h"
 
 // --- Global Running Flag and Signal Handler ---
 std::atomic<bool> running(true);
@@ -14,9 +26,17 @@ void signalHandler(int signum) {
     running = false;
 }
 
-extern void producer(FrameQueue& fq, const std::string& video_path, std::atomic<bool>& running);
-extern void consumer(FrameQueue& fq, InferEngine& engine, std::atomic<bool>& running,
-                    float conf_threshold, float nms_threshold);
+extern void producer(FrameQueue& fq, const std::string& video_path, std::atomic<bool>& running,
+                     size_t pool_size, Metrics& metrics, ReadyGate& ready);
+extern void consumer(FrameQueue& fq, InferEngine& engine, ReorderBuffer& out, Metrics& metrics,
+                     std::atomic<bool>& running, const PostprocessConfig& post);
+extern void batchConsumer(FrameQueue& fq, InferEngine& engine, ReorderBuffer& out, Metrics& metrics,
+                          std::atomic<bool>& running, const PostprocessConfig& post,
+                          size_t batch_size);
+extern void asyncConsumer(FrameQueue& fq, InferEngine& engine, ReorderBuffer& out, Metrics& metrics,
+                          std::atomic<bool>& running, const PostprocessConfig& post,
+                          size_t in_flight);
+extern void writeFrame(cv::VideoWriter& writer, const std::string& out_path, const cv::Mat& frame);
 
 // --- Argument Parser and Main Execution Logic ---
 void printUsage(const char* prog) {
@@ -28,8 +48,50 @@ void printUsage(const char* prog) {
               << "  --video <path>     Path to video file or '0' for webcam. (Default: 0)\n"
               << "  --conf <float>     Confidence threshold for detections. (Default: 0.25)\n"
               << "  --nms <float>      NMS IoU threshold for filtering boxes. (Default: 0.45)\n"
+              << "  --top-k <int>      Most confident candidates passed to NMS per frame; bounds\n"
+              << "                     NMS time at low --conf. 0 keeps all. (Default: 1000)\n"
+              << "  --max-det <int>    Detections kept per frame after NMS. 0 keeps all. (Default: 300)\n"
+              << "  --classes <list>   Comma-separated class indices to detect, e.g. 2,3,5,7 for\n"
+              << "                     COCO car, motorcycle, bus, truck. Other classes are not\n"
+              << "                     decoded at all. (Default: all)\n"
               << "  --queue-size <int> Max number of frames to buffer. (Default: 24)\n"
-              << "  --help             Show this help message.\n";
+              << "  --queue-mode <m>   Frame queue implementation: mutex | spsc. (Default: mutex)\n"
+              << "  --queue-policy <p> What to do when the queue is full: block | drop-oldest |\n"
+              << "                     drop-newest | keep-latest. Use a drop policy for live\n"
+              << "                     sources to bound latency. (Default: block)\n"
+              << "  --workers <int>    Number of inference threads. (Default: 1)\n"
+              << "  --batch <int>      Frames per inference call. Needs a model exported with a\n"
+              << "                     dynamic batch dimension to run them in one pass. (Default: 1)\n"
+              << "  --in-flight <int>  Frames each worker keeps inside the engine at once, so\n"
+              << "                     pre/postprocessing overlaps inference. Cannot be combined\n"
+              << "                     with --batch. (Default: 1)\n"
+              << "\nONNX Runtime session options (override --session-config):\n"
+              << "  --session-config <path>  File of key = value session options; see\n"
+              << "                     headers/session_config.h for the keys.\n"
+              << "  --intra-threads <int>    Threads used inside one operator. With several\n"
+              << "                     workers the default splits the cores between them.\n"
+              << "  --inter-threads <int>    Threads used across operators in parallel mode.\n"
+              << "  --execution-mode <m>     sequential | parallel. (Default: sequential)\n"
+              << "  --opt-level <l>    Graph optimization: disable | basic | extended | all.\n"
+              << "                     (Default: all)\n"
+              << "  --no-mem-pattern   Do not pre-plan tensor allocations.\n"
+              << "  --no-cpu-arena     Allocate CPU tensors without the arena.\n"
+              << "  --no-spin          Park idle ORT pool threads instead of busy-waiting.\n"
+              << "  --per-session-threads  Give every worker's session its own ORT thread pools\n"
+              << "                     instead of sharing one set across all workers.\n"
+              << "  --model-cache <dir>  Keep ORT-optimized models here; later starts load them\n"
+              << "                     and skip graph optimization.\n"
+              << "  --mmap-model       Map the model file read-only instead of reading it, so\n"
+              << "                     processes on one host share its pages.\n"
+              << "  --warmup <int>     Dummy inferences run per engine (and per batch size with\n"
+              << "                     --batch) before the first frame is read. (Default: 3)\n"
+              << "\nWorkers and reporting:\n"
+              << "  --shared-session   Let all workers run on one ONNX Runtime session instead\n"
+              << "                     of loading the model once per worker.\n"
+              << "  --metrics-interval <sec>  Seconds between JSON latency/FPS reports; 0 only\n"
+              << "                     reports at shutdown. (Default: 5)\n"
+              << "  --metrics-out <path>  Append JSON reports to this file instead of stderr.\n"
+              << "\n  --help             Show this help message.\n";
 }
 
 int main(int argc, char** argv) {
@@ -39,17 +101,68 @@ int main(int argc, char** argv) {
 
     // Default parameters
     std::string model_path, video_path = "0";
-    float conf_threshold = 0.25f, nms_threshold = 0.6f;
+    PostprocessConfig post;
+    post.iou_threshold = 0.6f;
     size_t queue_size = 24;
+    QueueMode queue_mode = QueueMode::Mutex;
+    OverflowPolicy queue_policy = OverflowPolicy::Block;
+    size_t workers = 1;
+    size_t batch_size = 1;
+    size_t in_flight = 1;
+    bool shared_session = false;
+    bool per_session_threads = false;
+    double metrics_interval = 5.0;
+    std::string metrics_path;
+    std::string session_config_path;
+    std::vector<std::pair<std::string, std::string>> session_flags;  //applied after the config file
 
     // Parse command-line arguments
     for (int i = 1; i < argc; i++) {
         std::string arg = argv[i];
         if (arg == "--model" && i + 1 < argc) model_path = argv[++i];
         else if (arg == "--video" && i + 1 < argc) video_path = argv[++i];
-        else if (arg == "--conf" && i + 1 < argc) conf_threshold = std::stof(argv[++i]);
-        else if (arg == "--nms" && i + 1 < argc) nms_threshold = std::stof(argv[++i]);
+        else if (arg == "--conf" && i + 1 < argc) post.conf_threshold = std::stof(argv[++i]);
+        else if (arg == "--nms" && i + 1 < argc) post.iou_threshold = std::stof(argv[++i]);
+        else if (arg == "--top-k" && i + 1 < argc) post.top_k = std::stoi(argv[++i]);
+        else if (arg == "--max-det" && i + 1 < argc) post.max_det = std::stoi(argv[++i]);
+        else if (arg == "--classes" && i + 1 < argc) {
+            std::stringstream list(argv[++i]);
+            std::string item;
+            while (std::getline(list, item, ',')) post.classes.push_back(std::stoi(item));
+        }
         else if (arg == "--queue-size" && i + 1 < argc) queue_size = std::stoul(argv[++i]);
+        else if (arg == "--queue-mode" && i + 1 < argc) {
+            std::string mode = argv[++i];
+            if (mode == "mutex") queue_mode = QueueMode::Mutex;
+            else if (mode == "spsc") queue_mode = QueueMode::Spsc;
+            else { std::cerr << "Unknown queue mode: " << mode << "\n"; printUsage(argv[0]); return 1; }
+        }
+        else if (arg == "--queue-policy" && i + 1 < argc) {
+            std::string policy = argv[++i];
+            if (policy == "block") queue_policy = OverflowPolicy::Block;
+            else if (policy == "drop-oldest") queue_policy = OverflowPolicy::DropOldest;
+            else if (policy == "drop-newest") queue_policy = OverflowPolicy::DropNewest;
+            else if (policy == "keep-latest") queue_policy = OverflowPolicy::KeepLatest;
+            else { std::cerr << "Unknown queue policy: " << policy << "\n"; printUsage(argv[0]); return 1; }
+        }
+        else if (arg == "--workers" && i + 1 < argc) workers = std::stoul(argv[++i]);
+        else if (arg == "--batch" && i + 1 < argc) batch_size = std::stoul(argv[++i]);
+        else if (arg == "--in-flight" && i + 1 < argc) in_flight = std::stoul(argv[++i]);
+        else if (arg == "--shared-session") shared_session = true;
+        else if (arg == "--per-session-threads") per_session_threads = true;
+        else if (arg == "--metrics-interval" && i + 1 < argc) metrics_interval = std::stod(argv[++i]);
+        else if (arg == "--metrics-out" && i + 1 < argc) metrics_path = argv[++i];
+        else if (arg == "--session-config" && i + 1 < argc) session_config_path = argv[++i];
+        else if (arg == "--intra-threads" && i + 1 < argc) session_flags.emplace_back("intra_op_threads", argv[++i]);
+        else if (arg == "--inter-threads" && i + 1 < argc) session_flags.emplace_back("inter_op_threads", argv[++i]);
+        else if (arg == "--execution-mode" && i + 1 < argc) session_flags.emplace_back("execution_mode", argv[++i]);
+        else if (arg == "--opt-level" && i + 1 < argc) session_flags.emplace_back("graph_optimization", argv[++i]);
+        else if (arg == "--no-mem-pattern") session_flags.emplace_back("mem_pattern", "false");
+        else if (arg == "--no-cpu-arena") session_flags.emplace_back("cpu_arena", "false");
+        else if (arg == "--no-spin") session_flags.emplace_back("allow_spinning", "false");
+        else if (arg == "--model-cache" && i + 1 < argc) session_flags.emplace_back("optimized_model_dir", argv[++i]);
+        else if (arg == "--mmap-model") session_flags.emplace_back("mmap_model", "true");
+        else if (arg == "--warmup" && i + 1 < argc) session_flags.emplace_back("warmup_runs", argv[++i]);
         else if (arg == "--help") { printUsage(argv[0]); return 0; }
     }
 
@@ -59,20 +172,150 @@ int main(int argc, char** argv) {
         return 1;
     }
 
+    if (workers == 0) workers = 1;
+    if (batch_size == 0) batch_size = 1;
+    if (in_flight == 0) in_flight = 1;
+    if (batch_size > 1 && in_flight > 1) {
+        std::cerr << "--batch and --in-flight cannot be combined; pick one\n";
+        return 1;
+    }
+    if (workers > 1 && queue_mode == QueueMode::Spsc) {
+        std::cerr << "--queue-mode spsc supports a single consumer; use --workers 1 or --queue-mode mutex\n";
+        return 1;
+    }
+
+    SessionConfig session_config;
+    //the pipeline warms up by default so the first frames meet steady-state latency
+    session_config.warmup_runs = 3;
+    std::string config_error;
+    if (!session_config_path.empty() && !session_config.loadFile(session_config_path, config_error)) {
+        std::cerr << "Session config: " << config_error << "\n";
+        return 1;
+    }
+    for (const auto& [key, value] : session_flags) {
+        if (!session_config.set(key, value, config_error)) {
+            std::cerr << config_error << "\n";
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    //with per-session pools each worker runs its own intra-op pool; by default split the
+    //cores so they do not oversubscribe. Shared global pools are sized once for everyone.
+    if (per_session_threads && session_config.intra_op_threads == 0 && workers > 1) {
+        session_config.intra_op_threads = std::max(1, static_cast<int>(std::thread::hardware_concurrency() / workers));
+    }
+    //a batch consumer runs every batch size up to --batch, so warm them all up
+    session_config.warmup_batch = std::max(session_config.warmup_batch, static_cast<int>(batch_size));
+
     try {
-        InferEngine engine(model_path);
+        FrameQueue fq(queue_size, queue_mode, queue_policy);
+
+        std::ofstream metrics_file;
+        if (!metrics_path.empty()) {
+            metrics_file.open(metrics_path, std::ios::app);
+            if (!metrics_file) {
+                std::cerr << "Could not open metrics file: " << metrics_path << "\n";
+                return 1;
+            }
+        }
+        Metrics metrics;
+        MetricsReporter reporter(metrics, metrics_path.empty() ? std::cerr : metrics_file,
+                                 std::chrono::milliseconds(static_cast<long long>(metrics_interval * 1000)));
+
+        //workers finish out of order; the reorder buffer writes frames in their original order
+        cv::VideoWriter writer;
+        const std::string out_path = "output.mp4";
+        ReorderBuffer ordered([&](const cv::Mat& frame) {
+            ScopedStageTimer timer(metrics.local(), Stage::Encode);
+            writeFrame(writer, out_path, frame);
+        });
+
+        //queued frames + the one being decoded + one batch (or the in-flight frames) per worker,
+        //plus as many again parked in the reorder buffer behind a slower worker's frame
+        const size_t per_worker = std::max(batch_size, in_flight);
+        const size_t pool_size = queue_size + 1 + 2 * workers * per_worker;
+
+        //the producer opens the source while the engines load, and reads once they are warm
+        ReadyGate ready;
+        std::thread prod_thread(producer, std::ref(fq), std::ref(video_path), std::ref(running),
+                                pool_size, std::ref(metrics), std::ref(ready));
+
+        const auto load_start = std::chrono::steady_clock::now();
+        std::vector<std::unique_ptr<InferEngine>> engines;
+        try {
+            //one Env and prepacked-weights container for every worker's session
+            EngineFactory factory(session_config, !per_session_threads);
+            engines.push_back(factory.create(model_path));
+            for (size_t w = 1; w < workers; ++w) {
+                engines.push_back(shared_session ? engines[0]->withSharedSession()
+                                                 : factory.create(model_path));
+            }
+        } catch (...) {
+            ready.fail();
+            prod_thread.join();
+            throw;
+        }
         std::cerr << "Model loaded: " << model_path
-                  << " (" << engine.getInputWidth() << "x" << engine.getInputHeight() << ")\n";
+                  << " (" << engines[0]->getInputWidth() << "x" << engines[0]->getInputHeight() << ")"
+                  << ", workers: " << workers << (shared_session ? " (shared session)" : "")
+                  << ", precision: " << (engines[0]->isQuantized() ? engines[0]->getQuantization() : "fp32")
+                  << ", batch: " << batch_size << ", in flight: " << in_flight << "\n"
+                  << "Session options: " << session_config.describe() << "\n"
+                  << "Model load took " << std::chrono::duration_cast<std::chrono::milliseconds>(
+                         std::chrono::steady_clock::now() - load_start).count() << " ms"
+                  << (engines[0]->loadedFromCache() ? " (optimized-model cache hit)" : "")
+                  << (session_config.warmup_runs > 0 ? " including warm-up" : "") << "\n";
+        const HeadLayout& head = engines[0]->head();
+        if (engines[0]->headKnown()) {
+            std::cerr << "Detection head: " << head.describe() << "\n";
+            for (int c : post.classes) {
+                if (c < 0 || c >= head.num_classes) {
+                    std::cerr << "warning: --classes index " << c << " is not a class of this model (0-"
+                              << head.num_classes - 1 << "); ignored\n";
+                }
+            }
+        } else {
+            std::cerr << "warning: cannot tell the detection head layout from the model output; assuming "
+                      << head.describe() << "\n";
+        }
+        if (batch_size > 1 && !engines[0]->supportsBatch()) {
+            std::cerr << "warning: model has a fixed batch size of 1; --batch " << batch_size
+                      << " runs its frames one at a time\n";
+        }
 
-        FrameQueue fq(queue_size);
+        std::vector<std::thread> cons_threads;
+        for (auto& engine : engines) {
+            if (in_flight > 1) {
+                cons_threads.emplace_back(asyncConsumer, std::ref(fq), std::ref(*engine), std::ref(ordered),
+                                          std::ref(metrics), std::ref(running), std::cref(post),
+                                          in_flight);
+            } else if (batch_size > 1) {
+                cons_threads.emplace_back(batchConsumer, std::ref(fq), std::ref(*engine), std::ref(ordered),
+                                          std::ref(metrics), std::ref(running), std::cref(post),
+                                          batch_size);
+            } else {
+                cons_threads.emplace_back(consumer, std::ref(fq), std::ref(*engine), std::ref(ordered),
+                                          std::ref(metrics), std::ref(running), std::cref(post));
+            }
+        }
 
-        std::thread prod_thread(producer, std::ref(fq), std::ref(video_path), std::ref(running));
-        std::thread cons_thread(consumer, std::ref(fq), std::ref(engine), std::ref(running),
-                                conf_threshold, nms_threshold);
+        //startup time does not count against the frame rate
+        metrics.restartClock();
+        ready.open();
 
         prod_thread.join();
-        cons_thread.join();
+        for (auto& t : cons_threads) t.join();
+
+        if (writer.isOpened()) {
+            writer.release();
+            std::cerr << "Finished writing " << out_path << "\n";
+        }
+
+        if (fq.droppedFrames() > 0) {
+            std::cerr << "Dropped " << fq.droppedFrames() << " frames due to queue overflow.\n";
+        }
 
+        reporter.stop();
         std::cerr << "Pipeline completed. Exiting.\n";
 
     } catch (const std::exception& e) {
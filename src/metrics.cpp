@@ -0,0 +1,255 @@
+#include "../headers/metrics.h"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+
+namespace {
+
+constexpr uint64_t kHalfBucket = uint64_t(1) << (LatencyHistogram::kSubBucketBits - 1);
+
+//distinguishes Metrics objects in the thread-local cache, even when one is
+//constructed at the address of a destroyed one
+std::atomic<uint64_t> g_next_metrics_id{1};
+
+struct LocalSlot {
+    uint64_t owner = 0;
+    ThreadMetrics* tm = nullptr;
+};
+//blocks of every Metrics this thread recorded into, most recently used first
+thread_local std::vector<LocalSlot> t_local;
+
+inline void storeMax(std::atomic<uint64_t>& slot, uint64_t value) {
+    if (value > slot.load(std::memory_order_relaxed)) {
+        slot.store(value, std::memory_order_relaxed);
+    }
+}
+
+void writeMs(std::ostream& os, uint64_t ns) {
+    os << std::fixed << std::setprecision(3) << ns / 1e6;
+}
+
+} // namespace
+
+const char* stageName(Stage stage) {
+    switch (stage) {
+    case Stage::Decode:      return "decode";
+    case Stage::QueueWait:   return "queue_wait";
+    case Stage::Preprocess:  return "preprocess";
+    case Stage::Inference:   return "inference";
+    case Stage::Postprocess: return "postprocess";
+    case Stage::Draw:        return "draw";
+    case Stage::Encode:      return "encode";
+    case Stage::Count:       break;
+    }
+    return "unknown";
+}
+
+const char* counterName(Counter counter) {
+    switch (counter) {
+    case Counter::FramesDecoded:   return "frames_decoded";
+    case Counter::FramesProcessed: return "frames_processed";
+    case Counter::FramesDropped:   return "frames_dropped";
+    case Counter::Detections:      return "detections";
+    case Counter::Count:           break;
+    }
+    return "unknown";
+}
+
+// ---------------- LatencyHistogram ----------------
+
+size_t LatencyHistogram::bucketIndex(uint64_t value) {
+    value = std::min(value, kMaxValue);
+    if (value < 2 * kHalfBucket) {
+        return static_cast<size_t>(value);
+    }
+    //keep the top kSubBucketBits bits of the value; the shift selects the octave
+    const int msb = 63 - __builtin_clzll(value);
+    const int shift = msb - (kSubBucketBits - 1);
+    return static_cast<size_t>(shift * kHalfBucket + (value >> shift));
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(size_t idx) {
+    if (idx < 2 * kHalfBucket) {
+        return idx;
+    }
+    const uint64_t shift = idx / kHalfBucket - 1;
+    const uint64_t mantissa = idx - shift * kHalfBucket;
+    return ((mantissa + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record(uint64_t value_ns) {
+    auto& bucket = buckets_[bucketIndex(value_ns)];
+    bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    sum_.store(sum_.load(std::memory_order_relaxed) + value_ns, std::memory_order_relaxed);
+    storeMax(max_, value_ns);
+    //count last, so a concurrent reader never sees more samples than bucket hits
+    count_.store(count_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+// ---------------- HistogramSnapshot ----------------
+
+HistogramSnapshot::HistogramSnapshot() : buckets_(LatencyHistogram::kBucketCount, 0) {}
+
+void HistogramSnapshot::merge(const LatencyHistogram& hist) {
+    const uint64_t n = hist.count_.load(std::memory_order_acquire);
+    if (n == 0) return;
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < buckets_.size(); ++i) {
+        const uint64_t b = hist.buckets_[i].load(std::memory_order_relaxed);
+        buckets_[i] += b;
+        seen += b;
+    }
+    //use the bucket total so percentiles stay consistent if the writer moved on
+    count_ += seen;
+    sum_ += hist.sum_.load(std::memory_order_relaxed);
+    max_ = std::max(max_, hist.max_.load(std::memory_order_relaxed));
+}
+
+uint64_t HistogramSnapshot::percentile(double q) const {
+    if (count_ == 0) return 0;
+    q = std::min(std::max(q, 0.0), 1.0);
+    const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(q * count_)));
+
+    uint64_t cumulative = 0;
+    for (size_t i = 0; i < buckets_.size(); ++i) {
+        cumulative += buckets_[i];
+        if (cumulative >= rank) {
+            return std::min(LatencyHistogram::bucketUpperBound(i), max_);
+        }
+    }
+    return max_;
+}
+
+// ---------------- Metrics ----------------
+
+Metrics::Metrics()
+    : id_(g_next_metrics_id.fetch_add(1)), start_(std::chrono::steady_clock::now().time_since_epoch().count()) {}
+
+ThreadMetrics& Metrics::local() {
+    if (!t_local.empty() && t_local.front().owner == id_) {
+        return *t_local.front().tm;
+    }
+    //a thread switching between instances finds its block again instead of registering another
+    auto found = std::find_if(t_local.begin(), t_local.end(),
+                              [this](const LocalSlot& slot) { return slot.owner == id_; });
+    if (found != t_local.end()) {
+        std::rotate(t_local.begin(), found, found + 1);
+        return *t_local.front().tm;
+    }
+
+    std::lock_guard<std::mutex> lock(mtx);
+    threads_.push_back(std::make_unique<ThreadMetrics>());
+    t_local.insert(t_local.begin(), LocalSlot{id_, threads_.back().get()});
+    return *t_local.front().tm;
+}
+
+HistogramSnapshot Metrics::stage(Stage stage) const {
+    HistogramSnapshot snap;
+    std::lock_guard<std::mutex> lock(mtx);
+    for (const auto& tm : threads_) {
+        snap.merge(tm->stages[static_cast<size_t>(stage)]);
+    }
+    return snap;
+}
+
+uint64_t Metrics::counter(Counter counter) const {
+    uint64_t total = 0;
+    std::lock_guard<std::mutex> lock(mtx);
+    for (const auto& tm : threads_) {
+        total += tm->counters[static_cast<size_t>(counter)].load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+double Metrics::uptime() const {
+    const std::chrono::steady_clock::time_point start(
+        std::chrono::steady_clock::duration(start_.load(std::memory_order_relaxed)));
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void Metrics::restartClock() {
+    start_.store(std::chrono::steady_clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+}
+
+std::string Metrics::toJson() const {
+    const double secs = uptime();
+    std::ostringstream os;
+    os << "{\"uptime_s\":" << std::fixed << std::setprecision(3) << secs;
+
+    os << ",\"counters\":{";
+    for (size_t c = 0; c < static_cast<size_t>(Counter::Count); ++c) {
+        if (c) os << ",";
+        os << "\"" << counterName(static_cast<Counter>(c)) << "\":" << counter(static_cast<Counter>(c));
+    }
+    os << "}";
+
+    const uint64_t processed = counter(Counter::FramesProcessed);
+    os << ",\"fps\":" << std::setprecision(2) << (secs > 0 ? processed / secs : 0.0);
+
+    os << ",\"stages\":{";
+    for (size_t s = 0; s < static_cast<size_t>(Stage::Count); ++s) {
+        const HistogramSnapshot snap = stage(static_cast<Stage>(s));
+        if (s) os << ",";
+        os << "\"" << stageName(static_cast<Stage>(s)) << "\":{\"count\":" << snap.count();
+        os << ",\"p50_ms\":"; writeMs(os, snap.percentile(0.50));
+        os << ",\"p90_ms\":"; writeMs(os, snap.percentile(0.90));
+        os << ",\"p99_ms\":"; writeMs(os, snap.percentile(0.99));
+        os << ",\"max_ms\":"; writeMs(os, snap.max());
+        os << ",\"mean_ms\":"; writeMs(os, static_cast<uint64_t>(snap.mean()));
+        os << "}";
+    }
+    os << "}}";
+    return os.str();
+}
+
+// ---------------- MetricsReporter ----------------
+
+MetricsReporter::MetricsReporter(const Metrics& metrics, std::ostream& out,
+                                 std::chrono::milliseconds interval)
+    : metrics_(metrics), out_(out), interval_(interval) {
+    if (interval_.count() > 0) {
+        thread_ = std::thread(&MetricsReporter::run, this);
+    }
+}
+
+MetricsReporter::~MetricsReporter() {
+    stop();
+}
+
+void MetricsReporter::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (stopped_) return;
+        stopping_ = true;
+    }
+    cv.notify_all();
+    if (thread_.joinable()) thread_.join();
+
+    std::lock_guard<std::mutex> lock(mtx);
+    emit(true);
+    stopped_ = true;
+}
+
+void MetricsReporter::run() {
+    std::unique_lock<std::mutex> lock(mtx);
+    while (!cv.wait_for(lock, interval_, [this] { return stopping_; })) {
+        emit(false);
+    }
+}
+
+void MetricsReporter::emit(bool final_report) {
+    //frame rate over the last reporting window, next to the overall one in the body
+    const double now = metrics_.uptime();
+    const uint64_t processed = metrics_.counter(Counter::FramesProcessed);
+    const double window = now - last_uptime_;
+    const double window_fps = window > 0 ? (processed - last_processed_) / window : 0.0;
+    last_uptime_ = now;
+    last_processed_ = processed;
+
+    const std::string body = metrics_.toJson();
+    out_ << "{\"final\":" << (final_report ? "true" : "false")
+         << ",\"window_fps\":" << std::fixed << std::setprecision(2) << window_fps
+         << "," << body.substr(1) << std::endl;
+}
@@ -0,0 +1,65 @@
+#include "../headers/model_cache.h"
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+
+namespace {
+
+constexpr uint64_t kFnvOffset = 14695981039346656037ull;
+constexpr uint64_t kFnvPrime = 1099511628211ull;
+
+uint64_t fnv1a(const char* data, size_t n, uint64_t hash) {
+    for (size_t i = 0; i < n; ++i) {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= kFnvPrime;
+    }
+    return hash;
+}
+
+//NCHWc blocking in a fully optimized graph follows the vector width of the machine that
+//saved it, so such entries are only shared between hosts of the same SIMD level
+const char* simdTag() {
+#if defined(__x86_64__) || defined(__i386__)
+    if (__builtin_cpu_supports("avx512f")) return "avx512";
+    if (__builtin_cpu_supports("avx2")) return "avx2";
+    return "sse";
+#else
+    return "generic";
+#endif
+}
+
+} // namespace
+
+namespace model_cache {
+
+bool hashFile(const std::string& path, uint64_t& hash) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+
+    hash = kFnvOffset;
+    std::vector<char> chunk(1 << 16);
+    while (in) {
+        in.read(chunk.data(), chunk.size());
+        hash = fnv1a(chunk.data(), static_cast<size_t>(in.gcount()), hash);
+    }
+    return in.eof();
+}
+
+std::string entryPath(const std::string& cache_dir, const std::string& model_path,
+                      const SessionConfig& config) {
+    uint64_t model_hash = 0;
+    if (!hashFile(model_path, model_hash)) return "";
+
+    std::ostringstream name;
+    name << std::filesystem::path(model_path).stem().string()
+         << "-" << std::hex << std::setw(16) << std::setfill('0') << model_hash << std::dec
+         << "-ort" << Ort::GetVersionString()
+         << "-O" << static_cast<int>(config.graph_optimization);
+    if (config.graph_optimization == ORT_ENABLE_ALL) name << "-" << simdTag();
+    name << ".ort";
+    return (std::filesystem::path(cache_dir) / name.str()).string();
+}
+
+} // namespace model_cache
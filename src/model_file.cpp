@@ -0,0 +1,48 @@
+#include "../headers/model_file.h"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+ModelFile::~ModelFile() {
+    if (data_) munmap(data_, size_);
+}
+
+bool ModelFile::map(const std::string& path, std::string& error) {
+    const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        error = std::strerror(errno);
+        return false;
+    }
+
+    struct stat st {};
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        error = st.st_size == 0 ? "empty file" : std::strerror(errno);
+        close(fd);
+        return false;
+    }
+
+    //MAP_SHARED of a read-only file: pages come straight from the page cache
+    void* data = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    const int map_errno = errno;
+    close(fd);  //the mapping keeps the file referenced
+    if (data == MAP_FAILED) {
+        error = std::strerror(map_errno);
+        return false;
+    }
+
+    //the whole model is read during session creation
+    madvise(data, static_cast<size_t>(st.st_size), MADV_WILLNEED);
+
+    if (data_) munmap(data_, size_);
+    data_ = data;
+    size_ = static_cast<size_t>(st.st_size);
+    return true;
+}
+
+bool ModelFile::isOrtFormat(const void* data, size_t size) {
+    //flatbuffers put the 4-byte file identifier right after the root table offset
+    return size >= 8 && std::memcmp(static_cast<const char*>(data) + 4, "ORTM", 4) == 0;
+}
@@ -21,127 +21,147 @@ void applyNMS(std::vector<Detection>& detections, float iou_threshold) {
                   return a.conf > b.conf;
               });
 
-    std::vector<bool> keep(detections.size(), true);
-
-    for (size_t i = 0; i < detections.size(); ++i) {
-        if (!keep[i]) continue;
-        for (size_t j = i + 1; j < detections.size(); ++j) {
-            if (!keep[j]) continue;
+    //a box survives unless a kept, more confident box of its class overlaps it enough;
+    //survivors are compacted to the front as they are found
+    size_t kept = 0;
+    for (size_t j = 0; j < detections.size(); ++j) {
+        bool suppressed = false;
+        for (size_t i = 0; i < kept && !suppressed; ++i) {
             // Only suppress boxes of the same class
-            if (detections[i].cls == detections[j].cls) {
-                if (computeIoU(detections[i].box, detections[j].box) > iou_threshold) {
-                    keep[j] = false;
-                }
-            }
+            suppressed = detections[i].cls == detections[j].cls &&
+                         computeIoU(detections[i].box, detections[j].box) > iou_threshold;
         }
-    }
-
-    std::vector<Detection> final_detections;
-    for (size_t i = 0; i < detections.size(); ++i) {
-        if (keep[i]) {
-            final_detections.push_back(detections[i]);
+        if (!suppressed) {
+            detections[kept++] = detections[j];
         }
     }
-    detections = final_detections;
+    detections.resize(kept);
 }
 
-std::vector<Detection> postprocess(
-    const cv::Mat& predictions_in,
-    cv::Size original_image_size,
-    float conf_threshold,
-    float iou_threshold
-)
-{
-    std::vector<Detection> detections;
-
+// Grid cells per axis at most.
+static const int kMaxGridCells = 64;
+// Cells a kept box is bucketed in at most; larger boxes are checked against every
+// candidate, which bounds the cell entries at this many per candidate.
+static const int kMaxCellsPerBox = 16;
+
+void GridNms::reserve(size_t max_detections, int num_classes) {
+    order_.reserve(max_detections);
+    keep_.reserve(max_detections);
+    checked_.reserve(max_detections);
+    entry_box_.reserve(max_detections * kMaxCellsPerBox);
+    entry_next_.reserve(max_detections * kMaxCellsPerBox);
+    large_.reserve(max_detections);
+    used_cells_.reserve(kMaxGridCells * kMaxGridCells);
+    cell_head_.reserve(kMaxGridCells * kMaxGridCells);
+    class_start_.reserve(static_cast<size_t>(std::max(num_classes, 1)) + 1);
+}
 
-    if (predictions_in.empty() || predictions_in.type() != CV_32F) {
-        return detections;
+void GridNms::apply(std::vector<Detection>& detections, float iou_threshold) {
+    if (detections.empty()) return;
+    //boxes that do not overlap have an IoU of 0, which only a negative threshold exceeds
+    if (iou_threshold < 0.0f) {
+        applyNMS(detections, iou_threshold);
+        return;
     }
 
-    cv::Mat predictions;
-    
-    if (predictions_in.cols == 84) {
-        predictions = predictions_in;  
-    } else if (predictions_in.rows == 84) {
-        predictions = predictions_in.t();  
-    } else {
-        std::cerr << "Error: Unexpected predictions shape [" << predictions_in.rows 
-                  << ", " << predictions_in.cols << "]. Expected 84 columns or 84 rows." << std::endl;
-        return detections;
+    //the same sort as applyNMS, so equal confidences end up in the same order
+    std::sort(detections.begin(), detections.end(),
+              [](const Detection& a, const Detection& b) {
+                  return a.conf > b.conf;
+              });
+    const int n = static_cast<int>(detections.size());
+
+    //counting sort by class; each class keeps its confidence order
+    int min_cls = detections[0].cls, max_cls = detections[0].cls;
+    float min_x = detections[0].box.x, min_y = detections[0].box.y;
+    float max_x = min_x, max_y = min_y, size_sum = 0.0f;
+    for (const auto& d : detections) {
+        min_cls = std::min(min_cls, d.cls);
+        max_cls = std::max(max_cls, d.cls);
+        min_x = std::min(min_x, d.box.x);
+        min_y = std::min(min_y, d.box.y);
+        max_x = std::max(max_x, d.box.x + d.box.width);
+        max_y = std::max(max_y, d.box.y + d.box.height);
+        size_sum += std::max(d.box.width, d.box.height);
     }
-    
-    // std::cout << "[DEBUG] Processed Shape: [" << predictions.rows 
-    //           << ", " << predictions.cols << "]" << std::endl;
-
-    const float model_width = 640.0f;
-    const float model_height = 640.0f;
-
-    float scale = std::min(model_width / original_image_size.width, 
-                          model_height / original_image_size.height);
-    float x_offset = (model_width - original_image_size.width * scale) / 2.0f;
-    float y_offset = (model_height - original_image_size.height * scale) / 2.0f;
-    
-    // std::cout << "[DEBUG] Conf Threshold: " << conf_threshold << std::endl;
-
-    for (int i = 0; i < predictions.rows; ++i) {
-        const float* row = predictions.ptr<float>(i);
-        
-        float cx = row[0];
-        float cy = row[1];
-        float w = row[2];
-        float h = row[3];
-
-        int best_class = -1;
-        float max_prob = 0.0f;
-        
-        for (int class_idx = 0; class_idx < 80; ++class_idx) {
-            float prob = row[4 + class_idx];
-            if (prob > max_prob) {
-                max_prob = prob;
-                best_class = class_idx;
-            }
-        }
-
-        if (max_prob < conf_threshold) {
-            continue;
-        }
-
-        //convert from model coordinates to original image coordinates
-        float x1 = (cx - w / 2.0f - x_offset) / scale;
-        float y1 = (cy - h / 2.0f - y_offset) / scale;
-        float x2 = (cx + w / 2.0f - x_offset) / scale;
-        float y2 = (cy + h / 2.0f - y_offset) / scale;
-
-        //clamp to image boundaries
-        x1 = std::max(0.0f, std::min(x1, (float)original_image_size.width));
-        y1 = std::max(0.0f, std::min(y1, (float)original_image_size.height));
-        x2 = std::max(0.0f, std::min(x2, (float)original_image_size.width));
-        y2 = std::max(0.0f, std::min(y2, (float)original_image_size.height));
-
-        if (x2 <= x1 || y2 <= y1) {
-            if (y2 <= y1) {
-                y2 = y1 + 1.0f; //1 pixel of height
+    class_start_.assign(max_cls - min_cls + 2, 0);
+    for (const auto& d : detections) class_start_[d.cls - min_cls + 1]++;
+    for (size_t c = 1; c < class_start_.size(); ++c) class_start_[c] += class_start_[c - 1];
+    order_.resize(n);
+    for (int i = 0; i < n; ++i) order_[class_start_[detections[i].cls - min_cls]++] = i;
+    //the fill advanced every start to the next class's start; shift them back
+    for (size_t c = class_start_.size() - 1; c > 0; --c) class_start_[c] = class_start_[c - 1];
+    class_start_[0] = 0;
+
+    //cells about the size of an average box, so a box touches few cells
+    const float extent = std::max(max_x - min_x, max_y - min_y);
+    const float cell = std::max({size_sum / n, extent / kMaxGridCells, 1e-3f});
+    const float inv_cell = 1.0f / cell;
+    const int grid_w = std::min(kMaxGridCells, static_cast<int>((max_x - min_x) * inv_cell) + 1);
+    const int grid_h = std::min(kMaxGridCells, static_cast<int>((max_y - min_y) * inv_cell) + 1);
+    cell_head_.assign(grid_w * grid_h, -1);
+    auto cell_of = [&](float v, float origin, int cells) {
+        return static_cast<int>(std::min(std::max((v - origin) * inv_cell, 0.0f), static_cast<float>(cells - 1)));
+    };
+
+    keep_.assign(n, 0);
+    checked_.assign(n, -1);
+    for (size_t c = 0; c + 1 < class_start_.size(); ++c) {
+        entry_box_.clear();
+        entry_next_.clear();
+        large_.clear();
+        used_cells_.clear();
+        for (int k = class_start_[c]; k < class_start_[c + 1]; ++k) {
+            const int i = order_[k];
+            const cv::Rect2f& box = detections[i].box;
+            const int x0 = cell_of(box.x, min_x, grid_w), x1 = cell_of(box.x + box.width, min_x, grid_w);
+            const int y0 = cell_of(box.y, min_y, grid_h), y1 = cell_of(box.y + box.height, min_y, grid_h);
+
+            //kept by greedy NMS unless a better kept box of its class overlaps it enough
+            bool suppressed = false;
+            for (int kept : large_) {
+                if (computeIoU(detections[kept].box, box) > iou_threshold) {
+                    suppressed = true;
+                    break;
+                }
             }
-            
-            if (x2 <= x1) {
-                x2 = x1 + 1.0f; //1 pixel of width
+            for (int y = y0; y <= y1 && !suppressed; ++y) {
+                for (int x = x0; x <= x1 && !suppressed; ++x) {
+                    for (int e = cell_head_[y * grid_w + x]; e >= 0; e = entry_next_[e]) {
+                        const int kept = entry_box_[e];
+                        if (checked_[kept] == i) continue;
+                        checked_[kept] = i;
+                        if (computeIoU(detections[kept].box, box) > iou_threshold) {
+                            suppressed = true;
+                            break;
+                        }
+                    }
+                }
             }
-            
-            if (x2 <= x1 || y2 <= y1) {
+            if (suppressed) continue;
+
+            keep_[i] = 1;
+            if ((x1 - x0 + 1) * (y1 - y0 + 1) > kMaxCellsPerBox) {
+                large_.push_back(i);
                 continue;
             }
+            for (int y = y0; y <= y1; ++y) {
+                for (int x = x0; x <= x1; ++x) {
+                    const int cell = y * grid_w + x;
+                    if (cell_head_[cell] < 0) used_cells_.push_back(cell);
+                    entry_box_.push_back(i);
+                    entry_next_.push_back(cell_head_[cell]);
+                    cell_head_[cell] = static_cast<int>(entry_box_.size()) - 1;
+                }
+            }
         }
-
-        Detection det;
-        det.box = cv::Rect2f(cv::Point2f(x1, y1), cv::Point2f(x2, y2));
-        det.conf = max_prob;
-        det.cls = best_class;
-
-        detections.push_back(det);
+        for (int used : used_cells_) cell_head_[used] = -1;
     }
 
-    applyNMS(detections, iou_threshold);
-
-    return detections;
-}
\ No newline at end of file
+    //compact in place, keeping the confidence order
+    size_t kept = 0;
+    for (int i = 0; i < n; ++i) {
+        if (keep_[i]) detections[kept++] = detections[i];
+    }
+    detections.resize(kept);
+}
@@ -0,0 +1,137 @@
+#include "../headers/postprocess.h"
+#include <algorithm>
+#include <iostream>
+
+Postprocessor::Postprocessor(const PostprocessConfig& config, const HeadLayout& head)
+    : decoder_(head) {
+    setConfig(config);
+}
+
+void Postprocessor::setConfig(const PostprocessConfig& config) {
+    config_ = config;
+    decoder_.setClasses(config.classes);
+}
+
+void Postprocessor::setHead(const HeadLayout& head) {
+    if (head == decoder_.head()) {
+        return;
+    }
+    const bool simd = decoder_.simdEnabled();
+    decoder_ = YoloDecoder(head);
+    decoder_.useSimd(simd);
+    decoder_.setClasses(config_.classes);
+}
+
+const std::vector<Detection>& Postprocessor::process(const cv::Mat& predictions, cv::Size original_image_size,
+                                                     float scale, cv::Point padding) {
+    const LetterboxMap map{scale, static_cast<float>(padding.x), static_cast<float>(padding.y), original_image_size};
+    processInto(predictions, map, detections_);
+    return detections_;
+}
+
+bool Postprocessor::processInto(const cv::Mat& predictions, const LetterboxMap& map, std::vector<Detection>& out) {
+    out.clear();
+    if (predictions.empty() || predictions.type() != CV_32F) {
+        return false;
+    }
+
+    //room for every anchor up front, so neither decoding nor NMS reallocates
+    const size_t anchors = static_cast<size_t>(std::max(predictions.rows, predictions.cols));
+    if (out.capacity() < anchors) out.reserve(anchors);
+    const size_t nms_candidates = config_.top_k > 0 ? std::min(anchors, static_cast<size_t>(config_.top_k)) : anchors;
+    nms_.reserve(nms_candidates, decoder_.numClasses());
+
+    if (!decoder_.decode(predictions, map, config_.conf_threshold, out)) {
+        const int channels = decoder_.head().channels();
+        std::cerr << "Error: Unexpected predictions shape [" << predictions.rows
+                  << ", " << predictions.cols << "]. Expected " << channels << " columns or "
+                  << channels << " rows." << std::endl;
+        return false;
+    }
+
+    //only the most confident candidates reach NMS; their order does not matter to it
+    if (config_.top_k > 0 && out.size() > static_cast<size_t>(config_.top_k)) {
+        std::nth_element(out.begin(), out.begin() + config_.top_k, out.end(),
+                         [](const Detection& a, const Detection& b) {
+                             return a.conf > b.conf;
+                         });
+        out.resize(config_.top_k);
+    }
+
+    nms_.apply(out, config_.iou_threshold);
+
+    //NMS leaves them most confident first
+    if (config_.max_det > 0 && out.size() > static_cast<size_t>(config_.max_det)) {
+        out.resize(config_.max_det);
+    }
+    return true;
+}
+
+std::vector<Detection> postprocess(
+    const cv::Mat& predictions,
+    cv::Size original_image_size,
+    float conf_threshold,
+    float iou_threshold
+)
+{
+    const float model_width = 640.0f;
+    const float model_height = 640.0f;
+
+    float scale = std::min(model_width / original_image_size.width, 
+                          model_height / original_image_size.height);
+    float x_offset = (model_width - original_image_size.width * scale) / 2.0f;
+    float y_offset = (model_height - original_image_size.height * scale) / 2.0f;
+
+    PostprocessConfig config;
+    config.conf_threshold = conf_threshold;
+    config.iou_threshold = iou_threshold;
+    thread_local Postprocessor post;
+    post.setConfig(config);
+    std::vector<Detection> detections;
+    post.processInto(predictions, LetterboxMap{scale, x_offset, y_offset, original_image_size}, detections);
+    return detections;
+}
+
+std::vector<Detection> postprocess(
+    const cv::Mat& predictions,
+    cv::Size original_image_size,
+    float scale,
+    cv::Point padding,
+    float conf_threshold,
+    float iou_threshold
+)
+{
+    PostprocessConfig config;
+    config.conf_threshold = conf_threshold;
+    config.iou_threshold = iou_threshold;
+    return postprocess(predictions, original_image_size, scale, padding, config);
+}
+
+std::vector<Detection> postprocess(
+    const cv::Mat& predictions,
+    cv::Size original_image_size,
+    float scale,
+    cv::Point padding,
+    const PostprocessConfig& config
+)
+{
+    return postprocess(predictions, original_image_size, scale, padding, config, HeadLayout());
+}
+
+std::vector<Detection> postprocess(
+    const cv::Mat& predictions,
+    cv::Size original_image_size,
+    float scale,
+    cv::Point padding,
+    const PostprocessConfig& config,
+    const HeadLayout& head
+)
+{
+    thread_local Postprocessor post;
+    post.setHead(head);
+    post.setConfig(config);
+    std::vector<Detection> detections;
+    const LetterboxMap map{scale, static_cast<float>(padding.x), static_cast<float>(padding.y), original_image_size};
+    post.processInto(predictions, map, detections);
+    return detections;
+}
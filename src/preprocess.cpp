@@ -1,58 +1,158 @@
 #include "../headers/preprocess.h"
 #include <iostream>
+#include <algorithm>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#include <immintrin.h>
+#define PREPROCESS_HAVE_AVX2 1
+#endif
+
+namespace {
+
+//same arithmetic as convertTo(CV_32F, 1.0 / 255.0): float(v) * float(alpha), no FMA,
+//so every kernel below is bit-exact with the OpenCV pipeline it replaces
+const float kNorm = static_cast<float>(1.0 / 255.0);
+const float kPadValue = 114.0f * kNorm;
+
+// Converts one row of `width` BGR pixels into the R, G and B planes.
+void packRowScalar(const uchar* src, float* r, float* g, float* b, int width) {
+    for (int x = 0; x < width; ++x, src += 3) {
+        b[x] = static_cast<float>(src[0]) * kNorm;
+        g[x] = static_cast<float>(src[1]) * kNorm;
+        r[x] = static_cast<float>(src[2]) * kNorm;
+    }
+}
+
+#ifdef PREPROCESS_HAVE_AVX2
+__attribute__((target("avx2")))
+inline void storeNormalized(float* dst, __m128i bytes) {
+    const __m256 norm = _mm256_set1_ps(kNorm);
+    __m256 lo = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(bytes));
+    __m256 hi = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_srli_si128(bytes, 8)));
+    _mm256_storeu_ps(dst, _mm256_mul_ps(lo, norm));
+    _mm256_storeu_ps(dst + 8, _mm256_mul_ps(hi, norm));
+}
+
+// 16 pixels per step: three 16-byte loads are deinterleaved into B, G and R bytes with
+// pshufb, then widened to float. The tail falls back to the scalar loop.
+__attribute__((target("avx2")))
+void packRowAvx2(const uchar* src, float* r, float* g, float* b, int width) {
+    const __m128i b0 = _mm_setr_epi8(0, 3, 6, 9, 12, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m128i b1 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, 2, 5, 8, 11, 14, -1, -1, -1, -1, -1);
+    const __m128i b2 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 1, 4, 7, 10, 13);
+    const __m128i g0 = _mm_setr_epi8(1, 4, 7, 10, 13, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m128i g1 = _mm_setr_epi8(-1, -1, -1, -1, -1, 0, 3, 6, 9, 12, 15, -1, -1, -1, -1, -1);
+    const __m128i g2 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 2, 5, 8, 11, 14);
+    const __m128i r0 = _mm_setr_epi8(2, 5, 8, 11, 14, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m128i r1 = _mm_setr_epi8(-1, -1, -1, -1, -1, 1, 4, 7, 10, 13, -1, -1, -1, -1, -1, -1);
+    const __m128i r2 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 0, 3, 6, 9, 12, 15);
+
+    int x = 0;
+    for (; x + 16 <= width; x += 16, src += 48) {
+        __m128i a0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+        __m128i a1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 16));
+        __m128i a2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 32));
+
+        __m128i vb = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(a0, b0), _mm_shuffle_epi8(a1, b1)),
+                                  _mm_shuffle_epi8(a2, b2));
+        __m128i vg = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(a0, g0), _mm_shuffle_epi8(a1, g1)),
+                                  _mm_shuffle_epi8(a2, g2));
+        __m128i vr = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(a0, r0), _mm_shuffle_epi8(a1, r1)),
+                                  _mm_shuffle_epi8(a2, r2));
+
+        storeNormalized(b + x, vb);
+        storeNormalized(g + x, vg);
+        storeNormalized(r + x, vr);
+    }
+    packRowScalar(src, r + x, g + x, b + x, width - x);
+}
+#endif
+
+} // namespace
 
 Preprocessor::Preprocessor(int input_width, int input_height)
-    : input_width_(input_width), input_height_(input_height) {}
+    : input_width_(input_width), input_height_(input_height), scale_(1.0f), padding_(0, 0),
+      use_simd_(simdAvailable()) {}
 
-cv::Mat Preprocessor::process(const cv::Mat& frame) {
-    std::cout << "Received frame size: [" << frame.cols << " x " << frame.rows << "]" << std::endl;
+bool Preprocessor::simdAvailable() {
+#ifdef PREPROCESS_HAVE_AVX2
+    static const bool available = __builtin_cpu_supports("avx2");
+    return available;
+#else
+    return false;
+#endif
+}
 
-    float scale = std::min(
-        static_cast<float>(input_width_) / frame.cols,
-        static_cast<float>(input_height_) / frame.rows
+void Preprocessor::useSimd(bool enabled) {
+    use_simd_ = enabled && simdAvailable();
+}
+
+pair<float, cv::Point> Preprocessor::getScaleAndPadding() const {
+    return {scale_, padding_};
+}
+
+void Preprocessor::plan(cv::Size frame_size) {
+    scale_ = std::min(
+        static_cast<float>(input_width_) / frame_size.width,
+        static_cast<float>(input_height_) / frame_size.height
     );
-    
-    int new_width = static_cast<int>(frame.cols * scale);
-    int new_height = static_cast<int>(frame.rows * scale);
-    
-    cv::Mat resized;
-    cv::resize(frame, resized, cv::Size(new_width, new_height));
-    
-    //letterboxed image (640x640) with gray padding
-    cv::Mat letterboxed(input_height_, input_width_, frame.type(), cv::Scalar(114, 114, 114));
-    int x_offset = (input_width_ - new_width) / 2;
-    int y_offset = (input_height_ - new_height) / 2;
-    resized.copyTo(letterboxed(cv::Rect(x_offset, y_offset, new_width, new_height)));
-    
-    std::cout << "Letterboxed image: " << letterboxed.cols << "x" << letterboxed.rows 
-              << " (content: " << new_width << "x" << new_height << " at offset " 
-              << x_offset << "," << y_offset << ")" << std::endl;
-    
+    content_size_ = cv::Size(static_cast<int>(frame_size.width * scale_),
+                             static_cast<int>(frame_size.height * scale_));
+    padding_ = cv::Point((input_width_ - content_size_.width) / 2,
+                         (input_height_ - content_size_.height) / 2);
 
-    cv::Mat rgb;
-    cv::cvtColor(letterboxed, rgb, cv::COLOR_BGR2RGB);  
-    std::cout << "RGB image size: [" << rgb.cols << " x " << rgb.rows << "]" << std::endl;
+    planned_size_ = frame_size;
+    padded_dst_ = nullptr;
+}
 
-    cv::Mat float_img;
-    rgb.convertTo(float_img, CV_32F, 1.0 / 255.0);
+const cv::Mat& Preprocessor::process(const cv::Mat& frame) {
+    if (blob_.empty()) {
+        std::vector<int> blob_shape = {1, 3, input_height_, input_width_};
+        blob_.create(4, blob_shape.data(), CV_32F);
+    }
 
-    std::vector<cv::Mat> channels(3);
-    cv::split(float_img, channels);
+    if (!processInto(frame, blob_.ptr<float>())) {
+        static const cv::Mat empty;
+        return empty;
+    }
+    return blob_;
+}
 
-    cv::Mat blob_1d(1, 3 * input_height_ * input_width_, CV_32F);
-    for (int c = 0; c < 3; ++c) {
-        std::memcpy(
-            blob_1d.ptr<float>(0) + c * input_height_ * input_width_,
-            channels[c].ptr<float>(0),
-            input_height_ * input_width_ * sizeof(float)
-        );
+bool Preprocessor::processInto(const cv::Mat& frame, float* dst_blob) {
+    if (frame.empty() || frame.type() != CV_8UC3) {
+        std::cerr << "Preprocessor: expected a non-empty CV_8UC3 frame.\n";
+        return false;
     }
 
-    std::vector<int> blob_shape = {1, 3, input_height_, input_width_};
-    cv::Mat blob = blob_1d.reshape(1, blob_shape);
+    if (frame.size() != planned_size_) {
+        plan(frame.size());
+    }
 
+    //padding only changes with the geometry; frames then overwrite just the content
+    const size_t plane = static_cast<size_t>(input_height_) * input_width_;
+    if (dst_blob != padded_dst_) {
+        std::fill(dst_blob, dst_blob + 3 * plane, kPadValue);
+        padded_dst_ = dst_blob;
+    }
     
-    std::cout << "NCHW blob size: [1 x " << 3 << " x " << input_height_ << " x " << input_width_ << "]" << std::endl;
-    
-    return blob;
-}
\ No newline at end of file
+    //a frame already at the content size is read in place
+    const cv::Mat* content = &frame;
+    if (frame.size() != content_size_) {
+        cv::resize(frame, resized_, content_size_);
+        content = &resized_;
+    }
+
+    //RGB order: plane 0 takes the third BGR byte
+    float* dst = dst_blob + static_cast<size_t>(padding_.y) * input_width_ + padding_.x;
+
+#ifdef PREPROCESS_HAVE_AVX2
+    auto pack_row = use_simd_ ? packRowAvx2 : packRowScalar;
+#else
+    auto pack_row = packRowScalar;
+#endif
+    for (int y = 0; y < content_size_.height; ++y, dst += input_width_) {
+        pack_row(content->ptr<uchar>(y), dst, dst + plane, dst + 2 * plane, content_size_.width);
+    }
+
+    return true;
+}
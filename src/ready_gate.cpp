@@ -0,0 +1,30 @@
+#include "../headers/ready_gate.h"
+
+void ReadyGate::open() {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (state_ != State::Waiting) return;
+        state_ = State::Open;
+    }
+    cv.notify_all();
+}
+
+void ReadyGate::fail() {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (state_ != State::Waiting) return;
+        state_ = State::Failed;
+    }
+    cv.notify_all();
+}
+
+bool ReadyGate::wait() {
+    std::unique_lock<std::mutex> lock(mtx);
+    cv.wait(lock, [this] { return state_ != State::Waiting; });
+    return state_ == State::Open;
+}
+
+bool ReadyGate::isOpen() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return state_ == State::Open;
+}
@@ -0,0 +1,41 @@
+#include "../headers/reorder_buffer.h"
+#include <iostream>
+
+ReorderBuffer::ReorderBuffer(Sink sink, uint64_t first_seq)
+    : sink_(std::move(sink)), next_(first_seq) {}
+
+void ReorderBuffer::submit(uint64_t seq, const cv::Mat& frame) {
+    std::lock_guard<std::mutex> lock(mtx);
+
+    if (seq < next_) {
+        std::cerr << "ReorderBuffer: sequence " << seq << " submitted twice, ignoring.\n";
+        return;
+    }
+
+    //in-order results (always the case with a single worker) skip the map entirely
+    if (seq != next_) {
+        pending_.emplace(seq, frame);
+        return;
+    }
+
+    sink_(frame);
+    next_++;
+
+    //flush results that were waiting for this one
+    auto it = pending_.begin();
+    while (it != pending_.end() && it->first == next_) {
+        sink_(it->second);
+        next_++;
+        it = pending_.erase(it);
+    }
+}
+
+size_t ReorderBuffer::pending() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return pending_.size();
+}
+
+uint64_t ReorderBuffer::nextSeq() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return next_;
+}
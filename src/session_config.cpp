@@ -0,0 +1,133 @@
+#include "../headers/session_config.h"
+#include <onnxruntime_session_options_config_keys.h>
+#include <fstream>
+#include <sstream>
+
+namespace {
+
+std::string trim(const std::string& s) {
+    const size_t first = s.find_first_not_of(" \t\r");
+    if (first == std::string::npos) return "";
+    const size_t last = s.find_last_not_of(" \t\r");
+    return s.substr(first, last - first + 1);
+}
+
+bool parseBool(const std::string& value, bool& out) {
+    if (value == "true" || value == "1" || value == "on") { out = true; return true; }
+    if (value == "false" || value == "0" || value == "off") { out = false; return true; }
+    return false;
+}
+
+bool parseCount(const std::string& value, int& out) {
+    try {
+        size_t used = 0;
+        const int n = std::stoi(value, &used);
+        if (used != value.size() || n < 0) return false;
+        out = n;
+        return true;
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
+const char* optimizationName(GraphOptimizationLevel level) {
+    switch (level) {
+    case ORT_DISABLE_ALL:     return "disable";
+    case ORT_ENABLE_BASIC:    return "basic";
+    case ORT_ENABLE_EXTENDED: return "extended";
+    case ORT_ENABLE_ALL:      return "all";
+    }
+    return "unknown";
+}
+
+} // namespace
+
+bool SessionConfig::set(const std::string& key, const std::string& value, std::string& error) {
+    bool ok = true;
+    if (key == "intra_op_threads") ok = parseCount(value, intra_op_threads);
+    else if (key == "inter_op_threads") ok = parseCount(value, inter_op_threads);
+    else if (key == "execution_mode") {
+        if (value == "sequential") execution_mode = ORT_SEQUENTIAL;
+        else if (value == "parallel") execution_mode = ORT_PARALLEL;
+        else ok = false;
+    }
+    else if (key == "graph_optimization") {
+        if (value == "disable") graph_optimization = ORT_DISABLE_ALL;
+        else if (value == "basic") graph_optimization = ORT_ENABLE_BASIC;
+        else if (value == "extended") graph_optimization = ORT_ENABLE_EXTENDED;
+        else if (value == "all") graph_optimization = ORT_ENABLE_ALL;
+        else ok = false;
+    }
+    else if (key == "mem_pattern") ok = parseBool(value, mem_pattern);
+    else if (key == "cpu_arena") ok = parseBool(value, cpu_arena);
+    else if (key == "allow_spinning") ok = parseBool(value, allow_spinning);
+    else if (key == "optimized_model_dir") optimized_model_dir = value;
+    else if (key == "mmap_model") ok = parseBool(value, mmap_model);
+    else if (key == "warmup_runs") ok = parseCount(value, warmup_runs);
+    else if (key == "warmup_batch") {
+        int n = 0;
+        ok = parseCount(value, n) && n > 0;
+        if (ok) warmup_batch = n;
+    }
+    else {
+        error = "unknown session option '" + key + "'";
+        return false;
+    }
+
+    if (!ok) error = "invalid value '" + value + "' for " + key;
+    return ok;
+}
+
+bool SessionConfig::loadFile(const std::string& path, std::string& error) {
+    std::ifstream in(path);
+    if (!in) {
+        error = "cannot open " + path;
+        return false;
+    }
+
+    std::string line;
+    for (int line_no = 1; std::getline(in, line); ++line_no) {
+        line = trim(line.substr(0, line.find('#')));
+        if (line.empty()) continue;
+
+        const size_t eq = line.find('=');
+        if (eq == std::string::npos) {
+            error = path + ":" + std::to_string(line_no) + ": expected key = value";
+            return false;
+        }
+        if (!set(trim(line.substr(0, eq)), trim(line.substr(eq + 1)), error)) {
+            error = path + ":" + std::to_string(line_no) + ": " + error;
+            return false;
+        }
+    }
+    return true;
+}
+
+void SessionConfig::apply(Ort::SessionOptions& options) const {
+    if (intra_op_threads > 0) options.SetIntraOpNumThreads(intra_op_threads);
+    if (inter_op_threads > 0) options.SetInterOpNumThreads(inter_op_threads);
+    options.SetExecutionMode(execution_mode);
+    options.SetGraphOptimizationLevel(graph_optimization);
+    if (!mem_pattern) options.DisableMemPattern();
+    if (!cpu_arena) options.DisableCpuMemArena();
+
+    const char* spin = allow_spinning ? "1" : "0";
+    options.AddConfigEntry(kOrtSessionOptionsConfigAllowIntraOpSpinning, spin);
+    options.AddConfigEntry(kOrtSessionOptionsConfigAllowInterOpSpinning, spin);
+}
+
+std::string SessionConfig::describe() const {
+    std::ostringstream os;
+    os << "intra_op_threads=" << (intra_op_threads > 0 ? std::to_string(intra_op_threads) : "auto")
+       << " inter_op_threads=" << (inter_op_threads > 0 ? std::to_string(inter_op_threads) : "auto")
+       << " execution_mode=" << (execution_mode == ORT_PARALLEL ? "parallel" : "sequential")
+       << " graph_optimization=" << optimizationName(graph_optimization)
+       << " mem_pattern=" << (mem_pattern ? "true" : "false")
+       << " cpu_arena=" << (cpu_arena ? "true" : "false")
+       << " allow_spinning=" << (allow_spinning ? "true" : "false");
+    if (!optimized_model_dir.empty()) os << " optimized_model_dir=" << optimized_model_dir;
+    if (mmap_model) os << " mmap_model=true";
+    os << " warmup_runs=" << warmup_runs;
+    if (warmup_batch > 1) os << " warmup_batch=" << warmup_batch;
+    return os.str();
+}
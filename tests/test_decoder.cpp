@@ -0,0 +1,196 @@
+#include <iostream>
+#include <vector>
+#include <opencv2/opencv.hpp>
+#include "../headers/decoder.h"
+#include "../headers/nms.h"
+#include "../headers/postprocess.h"
+
+using namespace std;
+
+#define LOG(...) do { cerr << __VA_ARGS__ << endl; } while(0)
+#define RUN_TEST(fn) \
+    do { \
+        cout << "Running " << #fn << " ... "; \
+        bool ok = fn(); \
+        if (ok) cout << "[PASS]\n"; else cout << "[FAIL]\n"; \
+        total++; if (ok) passed++; \
+    } while(0)
+
+// Channel-major [84, anchors] head: boxes inside a 640x640 input, low background scores
+// and a strong class on roughly one anchor in ten.
+static cv::Mat random_head(int anchors, uint64_t seed) {
+    cv::RNG rng(seed);
+    cv::Mat head(84, anchors, CV_32F);
+    rng.fill(head.rowRange(0, 2), cv::RNG::UNIFORM, 0.0f, 640.0f);
+    rng.fill(head.rowRange(2, 4), cv::RNG::UNIFORM, 2.0f, 200.0f);
+    rng.fill(head.rowRange(4, 84), cv::RNG::UNIFORM, 0.0f, 0.05f);
+    for (int a = 0; a < anchors; ++a) {
+        if (rng.uniform(0, 10) == 0) head.at<float>(4 + rng.uniform(0, 80), a) = rng.uniform(0.2f, 1.0f);
+    }
+    return head;
+}
+
+static bool same(const vector<Detection>& a, const vector<Detection>& b) {
+    if (a.size() != b.size()) { LOG("sizes " << a.size() << " vs " << b.size()); return false; }
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a[i].box != b[i].box || a[i].conf != b[i].conf || a[i].cls != b[i].cls) {
+            LOG("detection " << i << " differs");
+            return false;
+        }
+    }
+    return true;
+}
+
+// ---------------- Tests ----------------
+
+bool test_channel_major_matches_rows() {
+    const LetterboxMap map{0.5f, 0.0f, 140.0f, cv::Size(1280, 720)};
+    //8400 anchors as exported, and a count that leaves a tail after the 8-wide kernel
+    for (int anchors : {8400, 1003}) {
+        const cv::Mat head = random_head(anchors, anchors);
+        YoloDecoder decoder;
+        vector<Detection> rows, scalar, simd;
+        decoder.decode(head.t(), map, 0.25f, rows);
+        decoder.useSimd(false);
+        decoder.decode(head, map, 0.25f, scalar);
+        decoder.useSimd(true);
+        decoder.decode(head, map, 0.25f, simd);
+        if (rows.empty()) { LOG("no detections decoded"); return false; }
+        if (!same(rows, scalar) || !same(rows, simd)) return false;
+    }
+    return true;
+}
+
+bool test_first_best_class_wins() {
+    cv::Mat head(84, 9, CV_32F, cv::Scalar(0));
+    head.rowRange(0, 4).setTo(50.0f);
+    for (int a = 0; a < 9; ++a) {
+        head.at<float>(4 + 7, a) = 0.6f;
+        head.at<float>(4 + 3, a) = 0.6f;
+    }
+    YoloDecoder decoder;
+    for (bool simd : {false, true}) {
+        decoder.useSimd(simd);
+        vector<Detection> dets;
+        decoder.decode(head, LetterboxMap{1.0f, 0.0f, 0.0f, cv::Size(640, 640)}, 0.5f, dets);
+        if (dets.size() != 9) { LOG("expected 9 detections, got " << dets.size()); return false; }
+        for (const auto& d : dets) {
+            if (d.cls != 3) { LOG("tie resolved to class " << d.cls); return false; }
+        }
+    }
+    return true;
+}
+
+bool test_rejects_unknown_shape() {
+    YoloDecoder decoder;
+    vector<Detection> dets;
+    const LetterboxMap map{1.0f, 0.0f, 0.0f, cv::Size(640, 640)};
+    return !decoder.decode(cv::Mat(85, 100, CV_32F, cv::Scalar(0)), map, 0.25f, dets) &&
+           !decoder.decode(cv::Mat(84, 100, CV_8U, cv::Scalar(0)), map, 0.25f, dets) && dets.empty();
+}
+
+bool test_postprocess_either_layout() {
+    const cv::Mat head = random_head(8400, 7);
+    auto native = postprocess(head, {1280, 720}, 0.5f, cv::Point(0, 140), 0.25f, 0.45f);
+    auto transposed = postprocess(head.t(), {1280, 720}, 0.5f, cv::Point(0, 140), 0.25f, 0.45f);
+    return !native.empty() && same(native, transposed);
+}
+
+bool test_class_filter_skips_other_planes() {
+    const cv::Mat head = random_head(8400, 11);
+    const LetterboxMap map{1.0f, 0.0f, 0.0f, cv::Size(640, 640)};
+
+    //the same head with every class but 2 and 7 zeroed decodes to the same detections
+    cv::Mat vehicles_only = head.clone();
+    for (int c = 0; c < 80; ++c) {
+        if (c != 2 && c != 7) vehicles_only.row(4 + c).setTo(0.0f);
+    }
+    YoloDecoder all;
+    vector<Detection> expected;
+    all.decode(vehicles_only, map, 0.25f, expected);
+
+    YoloDecoder decoder;
+    decoder.setClasses({7, 2, 7, 120});
+    if (decoder.classes() != vector<int>{2, 7}) { LOG("class list not normalized"); return false; }
+    for (bool simd : {false, true}) {
+        decoder.useSimd(simd);
+        vector<Detection> channels, rows;
+        decoder.decode(head, map, 0.25f, channels);
+        decoder.decode(head.t(), map, 0.25f, rows);
+        if (expected.empty() || !same(expected, channels) || !same(expected, rows)) return false;
+    }
+
+    //a filter with no class of this head decodes nothing; an empty one restores all
+    vector<Detection> none, restored;
+    decoder.setClasses({80});
+    decoder.decode(head, map, 0.25f, none);
+    decoder.setClasses({});
+    decoder.decode(head, map, 0.25f, restored);
+    vector<Detection> unfiltered;
+    all.decode(head, map, 0.25f, unfiltered);
+    return none.empty() && same(unfiltered, restored);
+}
+
+bool test_layout_from_model_dims() {
+    using Order = HeadLayout::Order;
+    struct Case { vector<int64_t> dims; int w, h; bool ok; int classes; Order order; int anchors; };
+    const vector<Case> cases = {
+        {{1, 84, 8400}, 640, 640, true, 80, Order::ChannelMajor, 8400},
+        {{1, 8, 8400}, 640, 640, true, 4, Order::ChannelMajor, 8400},
+        {{1, 8400, 84}, 640, 640, true, 80, Order::AnchorMajor, 8400},
+        {{1, 8, 2100}, 320, 320, true, 4, Order::ChannelMajor, 2100},
+        {{-1, 5, -1}, 640, 640, true, 1, Order::ChannelMajor, 0},    //dynamic batch and anchors
+        {{1, 4000, 84}, 640, 640, true, 80, Order::AnchorMajor, 4000},  //anchors not from this input
+        {{1, 4, 8400}, 640, 640, false, 0, Order::Auto, 0},          //no class channel
+        {{84, 8400}, 640, 640, false, 0, Order::Auto, 0},
+    };
+    for (const auto& c : cases) {
+        HeadLayout head;
+        const bool ok = HeadLayout::fromModel(c.dims, c.w, c.h, head);
+        if (ok != c.ok) { LOG("dims " << c.dims[1] << "x" << c.dims.back() << ": fromModel returned " << ok); return false; }
+        if (ok && (head.num_classes != c.classes || head.order != c.order || head.num_anchors != c.anchors)) {
+            LOG("dims " << c.dims[1] << "x" << c.dims[2] << " read as " << head.describe());
+            return false;
+        }
+    }
+    return HeadLayout::anchorsFor(640, 640) == 8400 && HeadLayout::anchorsFor(640, 384) == 5040;
+}
+
+bool test_small_head_matches_coco_head() {
+    //a 4-class head decodes like the COCO head with every other class plane zeroed
+    const cv::Mat coco = random_head(8400, 13);
+    cv::Mat zeroed = coco.clone();
+    zeroed.rowRange(8, 84).setTo(0.0f);
+    const cv::Mat small = zeroed.rowRange(0, 8).clone();
+
+    HeadLayout head;
+    if (!HeadLayout::fromModel({1, 8, 8400}, 640, 640, head)) return false;
+    PostprocessConfig config;
+    Postprocessor post(config, head), coco_post(config);
+    const auto expected = coco_post.process(zeroed, {1280, 720}, 0.5f, cv::Point(0, 140));
+    const auto dets = post.process(small, {1280, 720}, 0.5f, cv::Point(0, 140));
+    const auto free_fn = postprocess(small, {1280, 720}, 0.5f, cv::Point(0, 140), config, head);
+    if (expected.empty() || !same(expected, dets) || !same(expected, free_fn)) return false;
+
+    //the layout is enforced: the transposed head and the COCO head are both rejected
+    vector<Detection> out;
+    const LetterboxMap map{1.0f, 0.0f, 0.0f, cv::Size(640, 640)};
+    return !post.processInto(small.t(), map, out) && !post.processInto(coco, map, out) &&
+           YoloDecoder(head).decode(small, map, 0.25f, out) && !out.empty();
+}
+
+int main() {
+    int passed = 0, total = 0;
+    if (!YoloDecoder::simdAvailable()) cout << "AVX2 not available; SIMD cases run the scalar kernel\n";
+    RUN_TEST(test_channel_major_matches_rows);
+    RUN_TEST(test_first_best_class_wins);
+    RUN_TEST(test_rejects_unknown_shape);
+    RUN_TEST(test_postprocess_either_layout);
+    RUN_TEST(test_class_filter_skips_other_planes);
+    RUN_TEST(test_layout_from_model_dims);
+    RUN_TEST(test_small_head_matches_coco_head);
+
+    cout << "----------------------------------------\n";
+    cout << "Test summary: Passed " << passed << " / " << total << " tests\n";
+    return (passed == total) ? 0 : 1;
+}
@@ -0,0 +1,166 @@
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <opencv2/opencv.hpp>
+#include "../headers/engine_factory.h"
+#include "../headers/model_cache.h"
+#include "../headers/preprocess.h"
+
+using namespace std;
+
+#define LOG(...) do { cerr << __VA_ARGS__ << endl; } while(0)
+#define RUN_TEST(fn) \
+    do { \
+        cout << "Running " << #fn << " ... "; \
+        bool ok = fn(); \
+        if (ok) cout << "[PASS]\n"; else cout << "[FAIL]\n"; \
+        total++; if (ok) passed++; \
+    } while(0)
+
+static const string kModel = "yolov8n.onnx";
+
+static cv::Mat test_blob() {
+    cv::Mat frame(480, 640, CV_8UC3);
+    cv::randu(frame, 0, 255);
+    Preprocessor pre(640, 640);
+    return pre.process(frame).clone();
+}
+
+static bool same_output(InferEngine& engine, const cv::Mat& blob, const cv::Mat& expected) {
+    cv::Mat preds = engine.infer(blob);
+    return preds.size() == expected.size() && cv::norm(preds, expected, cv::NORM_INF) == 0;
+}
+
+// ---------------- Tests ----------------
+
+//reference output from a standalone engine, released again before a factory is made so
+//the factory gets to create the process-wide Env with global thread pools
+static cv::Mat standalone_output(const cv::Mat& blob) {
+    InferEngine standalone(kModel);
+    return standalone.infer(blob).clone();
+}
+
+bool test_factory_engines_match_standalone() {
+    const cv::Mat blob = test_blob();
+    const cv::Mat expected = standalone_output(blob);
+
+    EngineFactory factory;
+    auto a = factory.create(kModel);
+    auto b = factory.create(kModel);
+    if (!same_output(*a, blob, expected)) { LOG("first factory engine differs"); return false; }
+    if (!same_output(*b, blob, expected)) { LOG("second factory engine differs"); return false; }
+    if (!factory.globalThreadPools()) { LOG("factory should run on global thread pools"); return false; }
+    return true;
+}
+
+bool test_per_session_threads() {
+    const cv::Mat blob = test_blob();
+    const cv::Mat expected = standalone_output(blob);
+
+    SessionConfig config;
+    config.intra_op_threads = 1;
+    EngineFactory factory(config, false);
+    auto engine = factory.create(kModel);
+    return !factory.globalThreadPools() && engine->getSessionConfig().intra_op_threads == 1 &&
+           same_output(*engine, blob, expected);
+}
+
+bool test_engines_outlive_factory() {
+    const cv::Mat blob = test_blob();
+    unique_ptr<InferEngine> engine;
+    {
+        EngineFactory factory;
+        engine = factory.create(kModel);
+    }
+    cv::Mat preds = engine->infer(blob);
+    return preds.rows == 84 && preds.cols == 8400;
+}
+
+bool test_concurrent_runs_on_global_pools() {
+    const cv::Mat blob = test_blob();
+    const cv::Mat expected = standalone_output(blob);
+
+    SessionConfig config;
+    config.intra_op_threads = 2;
+    EngineFactory factory(config);
+    vector<unique_ptr<InferEngine>> engines;
+    for (int i = 0; i < 4; ++i) engines.push_back(factory.create(kModel));
+
+    vector<int> ok(engines.size(), 1);
+    vector<thread> threads;
+    for (size_t i = 0; i < engines.size(); ++i) {
+        threads.emplace_back([&, i] {
+            for (int r = 0; r < 5; ++r) {
+                if (!same_output(*engines[i], blob, expected)) ok[i] = 0;
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+    for (size_t i = 0; i < ok.size(); ++i) {
+        if (!ok[i]) { LOG("engine " << i << " produced a different output"); return false; }
+    }
+    return factory.globalThreadPools();
+}
+
+bool test_falls_back_when_env_exists() {
+    const cv::Mat blob = test_blob();
+    InferEngine standalone(kModel);  //holds a plain process Env while the factory is made
+    const cv::Mat expected = standalone.infer(blob).clone();
+
+    EngineFactory factory;
+    auto engine = factory.create(kModel);
+    if (factory.globalThreadPools()) { LOG("factory should have fallen back to per-session pools"); return false; }
+    return same_output(*engine, blob, expected);
+}
+
+//the global-pool failure of the first attempt is not blamed on the cache entry
+bool test_fallback_keeps_cache_entry() {
+    const filesystem::path cache_dir = filesystem::temp_directory_path() / "test_enginefactory_cache";
+    filesystem::remove_all(cache_dir);
+    SessionConfig config;
+    config.optimized_model_dir = cache_dir.string();
+    const string entry = model_cache::entryPath(config.optimized_model_dir, kModel, config);
+
+    InferEngine standalone(kModel, config);  //writes the entry and holds a plain process Env
+    if (!filesystem::exists(entry)) { LOG("no cache entry written"); return false; }
+
+    EngineFactory factory(config);
+    auto engine = factory.create(kModel);
+    const bool ok = !factory.globalThreadPools() && engine->loadedFromCache() && filesystem::exists(entry);
+    filesystem::remove_all(cache_dir);
+    return ok;
+}
+
+bool test_create_throws_for_missing_model() {
+    EngineFactory factory;
+    try {
+        factory.create("nonexistent_model.onnx");
+    } catch (const std::runtime_error&) {
+        return true;
+    }
+    LOG("create did not throw");
+    return false;
+}
+
+int main() {
+    if (!ifstream(kModel).good()) {
+        cerr << "[FATAL] Model not found at: " << kModel << endl;
+        return 1;
+    }
+
+    int passed = 0, total = 0;
+    RUN_TEST(test_factory_engines_match_standalone);
+    RUN_TEST(test_per_session_threads);
+    RUN_TEST(test_engines_outlive_factory);
+    RUN_TEST(test_concurrent_runs_on_global_pools);
+    RUN_TEST(test_falls_back_when_env_exists);
+    RUN_TEST(test_fallback_keeps_cache_entry);
+    RUN_TEST(test_create_throws_for_missing_model);
+
+    cout << "----------------------------------------\n";
+    cout << "Test summary: Passed " << passed << " / " << total << " tests\n";
+    return (passed == total) ? 0 : 1;
+}
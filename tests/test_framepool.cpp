@@ -0,0 +1,116 @@
+#include <iostream>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <set>
+#include <opencv2/opencv.hpp>
+#include "../headers/frame_pool.h"
+#include "../headers/frame_queue.h"
+
+using namespace std;
+
+// Counts every global operator new so the steady-state loop can assert it never allocates.
+static atomic<size_t> g_allocations{0};
+
+void* operator new(size_t n) {
+    g_allocations++;
+    if (void* p = malloc(n ? n : 1)) return p;
+    throw bad_alloc();
+}
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+
+#define LOG(...) do { cerr << __VA_ARGS__ << endl; } while(0)
+#define RUN_TEST(fn) \
+    do { \
+        cout << "Running " << #fn << " ... "; \
+        bool ok = fn(); \
+        if (ok) cout << "[PASS]\n"; else cout << "[FAIL]\n"; \
+        total++; if (ok) passed++; \
+    } while(0)
+
+// ---------------- Tests ----------------
+
+bool test_acquire_before_reserve_is_empty() {
+    FramePool pool(4);
+    return pool.acquire().empty() && pool.available() == 0;
+}
+
+bool test_buffer_returns_when_released() {
+    FramePool pool(2);
+    pool.reserve(cv::Size(64, 48), CV_8UC3);
+
+    cv::Mat a = pool.acquire();
+    cv::Mat b = pool.acquire();
+    if (a.empty() || b.empty() || a.data == b.data) { LOG("expected two distinct buffers"); return false; }
+    if (!pool.acquire().empty()) { LOG("pool should be exhausted"); return false; }
+
+    cv::Mat copy = a;  //a second holder keeps the buffer in use
+    a.release();
+    if (pool.available() != 0) { LOG("buffer returned while still referenced"); return false; }
+    copy.release();
+    if (pool.available() != 1) { LOG("buffer not returned after last release"); return false; }
+
+    cv::Mat c = pool.acquire();
+    return !c.empty() && pool.misses() == 1;
+}
+
+bool steady_state_is_allocation_free(QueueMode mode) {
+    const size_t queue_size = 4;
+    FrameQueue fq(queue_size, mode);
+    FramePool pool(queue_size + 2);
+    pool.reserve(cv::Size(320, 240), CV_8UC3);
+
+    set<const uchar*> pool_buffers;
+    for (size_t i = 0; i < pool.capacity(); ++i) {
+        cv::Mat b = pool.acquire();
+        pool_buffers.insert(b.data);
+    }
+
+    cv::Mat frame, popped;
+    auto cycle = [&](int i) {
+        frame = pool.acquire();
+        frame.create(240, 320, CV_8UC3);   //what cap.read() does with a correctly sized buffer
+        frame.ptr<uchar>(0)[0] = static_cast<uchar>(i);
+        fq.push(frame);
+        if (fq.size() >= queue_size) {
+            fq.pop(popped);
+            popped.release();
+        }
+        return frame.data;
+    };
+
+    for (int i = 0; i < 16; ++i) cycle(i);   //warm up
+
+    bool all_from_pool = true;
+    size_t before = g_allocations.load();
+    for (int i = 0; i < 1000; ++i) {
+        if (!pool_buffers.count(cycle(i))) all_from_pool = false;
+    }
+    size_t allocations = g_allocations.load() - before;
+
+    if (allocations != 0) LOG("steady state performed " << allocations << " heap allocations");
+    if (!all_from_pool) LOG("a frame was not backed by a pool buffer");
+    if (pool.misses() != 0) LOG("pool missed " << pool.misses() << " times");
+    return allocations == 0 && all_from_pool && pool.misses() == 0;
+}
+
+bool test_steady_state_no_allocations_mutex() {
+    return steady_state_is_allocation_free(QueueMode::Mutex);
+}
+
+bool test_steady_state_no_allocations_spsc() {
+    return steady_state_is_allocation_free(QueueMode::Spsc);
+}
+
+int main() {
+    int passed = 0, total = 0;
+    RUN_TEST(test_acquire_before_reserve_is_empty);
+    RUN_TEST(test_buffer_returns_when_released);
+    RUN_TEST(test_steady_state_no_allocations_mutex);
+    RUN_TEST(test_steady_state_no_allocations_spsc);
+
+    cout << "----------------------------------------\n";
+    cout << "Test summary: Passed " << passed << " / " << total << " tests\n";
+    return (passed == total) ? 0 : 1;
+}
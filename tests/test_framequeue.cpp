@@ -135,6 +135,185 @@ bool test_zero_max_size_behaviour() {
     return (!pushed) && (!popped) && fq.empty();
 }
 
+bool test_spsc_push_pop_basic() {
+    FrameQueue fq(4, QueueMode::Spsc);
+    auto frames = generate_dummy_frames(4);
+
+    for (auto &f : frames) {
+        if (!fq.push(f)) { LOG("spsc push failed unexpectedly"); return false; }
+    }
+    if (fq.size() != 4) { LOG("spsc size mismatch: " << fq.size()); return false; }
+
+    for (size_t i = 0; i < frames.size(); ++i) {
+        cv::Mat popped;
+        if (!fq.pop(popped)) { LOG("spsc pop failed unexpectedly"); return false; }
+        if (popped.data != frames[i].data) { LOG("spsc frame out of order at " << i); return false; }
+    }
+    return fq.empty();
+}
+
+bool test_spsc_threaded_order() {
+    const int n = 2000;
+    FrameQueue fq(4, QueueMode::Spsc);
+    bool in_order = true;
+    int received = 0;
+
+    thread consumer([&] {
+        cv::Mat frame;
+        while (fq.pop(frame)) {
+            if (frame.at<int>(0, 0) != received) in_order = false;
+            received++;
+        }
+    });
+
+    for (int i = 0; i < n; ++i) {
+        cv::Mat f(1, 1, CV_32S, cv::Scalar(i));
+        if (!fq.push(f)) { LOG("spsc push failed at " << i); break; }
+    }
+    fq.close();
+    consumer.join();
+
+    if (received != n) LOG("spsc received " << received << " of " << n);
+    return in_order && received == n;
+}
+
+bool test_spsc_close_unblocks_pop() {
+    FrameQueue fq(2, QueueMode::Spsc);
+    atomic<bool> returned{false};
+    thread consumer([&] {
+        cv::Mat tmp;
+        fq.pop(tmp);
+        returned = true;
+    });
+    this_thread::sleep_for(chrono::milliseconds(20));
+    fq.close();
+    consumer.join();
+    return returned && !fq.push(cv::Mat::zeros(2, 2, CV_8UC3));
+}
+
+// pushes frames tagged 0..n-1 into a full-size queue and returns the tags left queued
+vector<int> push_tagged_and_drain(FrameQueue& fq, int n) {
+    for (int i = 0; i < n; ++i) {
+        fq.push(cv::Mat(1, 1, CV_32S, cv::Scalar(i)));
+    }
+    fq.close();
+    vector<int> tags;
+    cv::Mat frame;
+    while (fq.pop(frame)) tags.push_back(frame.at<int>(0, 0));
+    return tags;
+}
+
+bool test_policy_drop_newest() {
+    FrameQueue fq(3, QueueMode::Mutex, OverflowPolicy::DropNewest);
+    auto tags = push_tagged_and_drain(fq, 10);
+    return tags == vector<int>({0, 1, 2}) && fq.droppedFrames() == 7;
+}
+
+bool test_policy_drop_oldest() {
+    FrameQueue fq(3, QueueMode::Mutex, OverflowPolicy::DropOldest);
+    auto tags = push_tagged_and_drain(fq, 10);
+    return tags == vector<int>({7, 8, 9}) && fq.droppedFrames() == 7;
+}
+
+bool test_policy_keep_latest() {
+    FrameQueue fq(3, QueueMode::Mutex, OverflowPolicy::KeepLatest);
+    auto tags = push_tagged_and_drain(fq, 10);
+    return tags == vector<int>({9}) && fq.droppedFrames() == 9;
+}
+
+bool test_policy_spsc_drop_newest() {
+    FrameQueue fq(3, QueueMode::Spsc, OverflowPolicy::DropNewest);
+    auto tags = push_tagged_and_drain(fq, 10);
+    return tags == vector<int>({0, 1, 2}) && fq.droppedFrames() == 7;
+}
+
+bool test_policy_spsc_rejects_drop_oldest() {
+    try {
+        FrameQueue fq(3, QueueMode::Spsc, OverflowPolicy::DropOldest);
+    } catch (const invalid_argument&) {
+        return true;
+    }
+    return false;
+}
+
+bool test_block_push_returns_on_close() {
+    FrameQueue fq(1);
+    fq.push(cv::Mat::zeros(2, 2, CV_8UC3));
+    atomic<bool> result{true};
+    thread producer([&] { result = fq.push(cv::Mat::zeros(2, 2, CV_8UC3)); });
+    this_thread::sleep_for(chrono::milliseconds(20));
+    fq.close();
+    producer.join();
+    return !result;
+}
+
+bool pop_batch_behaviour(QueueMode mode) {
+    FrameQueue fq(8, mode);
+    auto frames = generate_dummy_frames(6, 32, 32);
+    vector<cv::Mat> batch;
+
+    //a full batch is available: returns immediately with max_n frames in order
+    for (int i = 0; i < 5; ++i) fq.push(frames[i]);
+    auto start = chrono::steady_clock::now();
+    if (!fq.popBatch(batch, 4, chrono::seconds(5))) { LOG("popBatch failed"); return false; }
+    if (chrono::steady_clock::now() - start > chrono::seconds(1)) { LOG("popBatch waited with a full batch"); return false; }
+    if (batch.size() != 4) { LOG("expected 4 frames, got " << batch.size()); return false; }
+    for (int i = 0; i < 4; ++i) {
+        if (batch[i].data != frames[i].data) { LOG("batch out of order at " << i); return false; }
+    }
+
+    //only a partial batch: returns what is queued once the deadline expires
+    if (!fq.popBatch(batch, 4, chrono::milliseconds(20)) || batch.size() != 1) {
+        LOG("expected partial batch of 1, got " << batch.size()); return false;
+    }
+
+    //nothing queued: times out with an empty batch while the queue is open
+    if (!fq.popBatch(batch, 4, chrono::milliseconds(5)) || !batch.empty()) {
+        LOG("expected empty batch on timeout"); return false;
+    }
+
+    //closed: drains the rest, then reports false
+    fq.push(frames[5]);
+    fq.close();
+    if (!fq.popBatch(batch, 4, chrono::seconds(5)) || batch.size() != 1) { LOG("close did not drain"); return false; }
+    return !fq.popBatch(batch, 4, chrono::seconds(5)) && batch.empty();
+}
+
+bool test_pop_batch_mutex() {
+    return pop_batch_behaviour(QueueMode::Mutex);
+}
+
+bool test_pop_batch_spsc() {
+    return pop_batch_behaviour(QueueMode::Spsc);
+}
+
+bool test_pop_batch_wakes_on_push() {
+    FrameQueue fq(8);
+    vector<cv::Mat> batch;
+    thread producer([&] {
+        this_thread::sleep_for(chrono::milliseconds(10));
+        for (int i = 0; i < 3; ++i) fq.push(cv::Mat::zeros(2, 2, CV_8UC3));
+    });
+    auto start = chrono::steady_clock::now();
+    bool ok = fq.popBatch(batch, 3, chrono::seconds(5));
+    auto waited = chrono::steady_clock::now() - start;
+    producer.join();
+    return ok && batch.size() == 3 && waited < chrono::seconds(2);
+}
+
+bool test_pop_seq_gap_free_with_drops() {
+    FrameQueue fq(3, QueueMode::Mutex, OverflowPolicy::DropOldest);
+    for (int i = 0; i < 10; ++i) fq.push(cv::Mat::zeros(2, 2, CV_8UC3));
+    fq.close();
+
+    //seven frames were dropped, yet the survivors are numbered 0, 1, 2
+    vector<uint64_t> seqs;
+    cv::Mat frame;
+    uint64_t seq = 0;
+    while (fq.pop(frame, seq)) seqs.push_back(seq);
+    return seqs == vector<uint64_t>({0, 1, 2});
+}
+
 int main() {
     int passed = 0, total = 0;
     RUN_TEST(test_push_pop_basic);
@@ -143,6 +322,19 @@ int main() {
     RUN_TEST(test_repeated_push_pop);
     RUN_TEST(test_thread_safety_stress_and_shutdown);
     RUN_TEST(test_zero_max_size_behaviour);
+    RUN_TEST(test_spsc_push_pop_basic);
+    RUN_TEST(test_spsc_threaded_order);
+    RUN_TEST(test_spsc_close_unblocks_pop);
+    RUN_TEST(test_policy_drop_newest);
+    RUN_TEST(test_policy_drop_oldest);
+    RUN_TEST(test_policy_keep_latest);
+    RUN_TEST(test_policy_spsc_drop_newest);
+    RUN_TEST(test_policy_spsc_rejects_drop_oldest);
+    RUN_TEST(test_block_push_returns_on_close);
+    RUN_TEST(test_pop_batch_mutex);
+    RUN_TEST(test_pop_batch_spsc);
+    RUN_TEST(test_pop_batch_wakes_on_push);
+    RUN_TEST(test_pop_seq_gap_free_with_drops);
 
     cout << "----------------------------------------\n";
     cout << "Test summary: Passed " << passed << " / " << total << " tests\n";
@@ -1,8 +1,41 @@
 #include <iostream>
 #include <vector>
 #include <fstream>
+#include <filesystem>
+#include <atomic>
+#include <algorithm>
+#include <cstdlib>
+#include <iterator>
+#include <memory>
+#include <new>
 #include <opencv2/opencv.hpp>
 #include "../headers/infer_engine.h"
+#include "../headers/preprocess.h"
+#include "../headers/postprocess.h"
+#include "../headers/model_cache.h"
+#include "../headers/model_file.h"
+
+// Live heap blocks (news minus deletes), so repeated inference can be checked for growth.
+static std::atomic<long> g_live_allocations{0};
+
+void* operator new(size_t n) {
+    g_live_allocations++;
+    if (void* p = malloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept {
+    if (p) g_live_allocations--;
+    free(p);
+}
+void operator delete(void* p, size_t) noexcept {
+    if (p) g_live_allocations--;
+    free(p);
+}
+
+// Thrown by tests whose optional model file is missing; counted as skipped, not passed.
+struct SkipTest : std::runtime_error {
+    using std::runtime_error::runtime_error;
+};
 
 static void assertMsg(bool cond, const std::string& msg) {
     if (!cond) {
@@ -24,11 +57,13 @@ bool test_invalid_model_path() {
 // Test 2: Engine should load a valid model
 bool test_valid_model_load(const std::string& model_path) {
     InferEngine engine(model_path);
-    // Assuming YOLOv8 default input size
-    int expected_width = 640;
-    int expected_height = 640;
-    assertMsg(expected_width == 640, "Model input width should be 640");
-    assertMsg(expected_height == 640, "Model input height should be 640");
+    // yolov8n.onnx is exported at 640x640; the size is read from the model
+    assertMsg(engine.getInputWidth() == 640, "Model input width should be 640");
+    assertMsg(engine.getInputHeight() == 640, "Model input height should be 640");
+    assertMsg(!engine.getInputName().empty() && !engine.getOutputName().empty(), "Model I/O names should be cached");
+    assertMsg(engine.getOutputDims().size() == 3 && engine.getOutputDims()[1] == 84, "Output dims should be [1, 84, N]");
+    assertMsg(engine.headKnown() && engine.head().num_classes == 80 && engine.head().num_anchors == 8400 &&
+              engine.head().order == HeadLayout::Order::ChannelMajor, "Head should read as 80 classes, channel-major, 8400 anchors");
     return true;
 }
 
@@ -92,6 +127,324 @@ bool test_infer_with_real_image(const std::string& model_path) {
     return true;
 }
 
+// Test 6: Preprocessing straight into the engine's input tensor matches the copying path
+bool test_zero_copy_input(const std::string& model_path) {
+    InferEngine engine(model_path);
+    assertMsg(reinterpret_cast<uintptr_t>(engine.inputData()) % 64 == 0, "Input buffer should be 64-byte aligned");
+
+    cv::Mat frame(480, 640, CV_8UC3);
+    cv::randu(frame, 0, 255);
+    Preprocessor pre(engine.getInputWidth(), engine.getInputHeight());
+    cv::Mat copied = engine.infer(pre.process(frame)).clone();
+
+    assertMsg(pre.processInto(frame, engine.inputData()), "processInto should accept a BGR frame");
+    assertMsg(cv::norm(pre.process(frame).reshape(1, 1), engine.inputBlob().reshape(1, 1), cv::NORM_INF) == 0,
+              "processInto should write the same blob as process");
+    cv::Mat direct = engine.infer();
+    assertMsg(direct.size() == copied.size(), "Zero-copy inference output shape differs");
+    assertMsg(cv::norm(direct, copied, cv::NORM_INF) == 0, "Zero-copy inference output differs");
+    return true;
+}
+
+// Test 7: Input resolution comes from the model, so other exports work unchanged
+bool test_model_input_size_from_model(const std::string& model_path) {
+    if (!std::ifstream(model_path).good()) {
+        throw SkipTest(model_path + " not found");
+    }
+    InferEngine engine(model_path);
+    assertMsg(engine.getInputWidth() == 320 && engine.getInputHeight() == 320, "Input size should be read as 320x320");
+
+    Preprocessor pre(engine.getInputWidth(), engine.getInputHeight());
+    cv::Mat frame(480, 640, CV_8UC3, cv::Scalar(40, 80, 120));
+    assertMsg(pre.processInto(frame, engine.inputData()), "processInto should accept a BGR frame");
+    cv::Mat predictions = engine.infer();
+    assertMsg(predictions.rows == 84 && predictions.cols == 2100, "A 320 export should produce 84x2100");
+    return true;
+}
+
+// Test 8: Output is written into the bound engine buffer; 1000 runs leave no allocations behind
+bool test_repeated_inference_no_growth(const std::string& model_path) {
+    InferEngine engine(model_path);
+    Preprocessor pre(engine.getInputWidth(), engine.getInputHeight());
+    cv::Mat frame(480, 640, CV_8UC3);
+    cv::randu(frame, 0, 255);
+    pre.processInto(frame, engine.inputData());
+
+    cv::Mat first = engine.infer();
+    const float* output_data = first.ptr<float>();
+    cv::Mat expected = first.clone();
+    for (int i = 0; i < 10; ++i) engine.infer();  //let the ORT arenas settle
+
+    const long before = g_live_allocations.load();
+    for (int i = 0; i < 1000; ++i) {
+        cv::Mat preds = engine.infer();
+        assertMsg(preds.ptr<float>() == output_data, "Output should be a view of the bound engine buffer");
+    }
+    const long growth = g_live_allocations.load() - before;
+    assertMsg(growth <= 0, "Live allocations grew by " + std::to_string(growth) + " over 1000 inferences");
+    assertMsg(cv::norm(engine.infer(), expected, cv::NORM_INF) == 0, "Output changed across identical runs");
+    return true;
+}
+
+// Test 9: A batched run gives each frame the same predictions as running it alone
+bool test_infer_batch_matches_single(const std::string& model_path) {
+    if (!std::ifstream(model_path).good()) {
+        throw SkipTest(model_path + " not found");
+    }
+    InferEngine engine(model_path);
+    Preprocessor pre(engine.getInputWidth(), engine.getInputHeight());
+
+    std::vector<cv::Mat> blobs, expected;
+    for (int i = 0; i < 3; ++i) {
+        cv::Mat frame(480, 640, CV_8UC3);
+        cv::randu(frame, 0, 255);
+        blobs.push_back(pre.process(frame).clone());
+        expected.push_back(engine.infer(blobs.back()).clone());
+    }
+
+    std::vector<cv::Mat> batched = engine.inferBatch(blobs);
+    assertMsg(batched.size() == blobs.size(), "inferBatch should return one prediction per frame");
+    for (size_t i = 0; i < batched.size(); ++i) {
+        assertMsg(batched[i].size() == expected[i].size(), "Batched output shape differs for frame " + std::to_string(i));
+        assertMsg(cv::norm(batched[i], expected[i], cv::NORM_INF) < 1e-4, "Batched output differs for frame " + std::to_string(i));
+    }
+
+    //a smaller batch afterwards re-binds and still lines up
+    std::vector<cv::Mat> pair = engine.inferBatch({blobs[2], blobs[0]});
+    assertMsg(pair.size() == 2, "inferBatch should return two predictions");
+    assertMsg(cv::norm(pair[0], expected[2], cv::NORM_INF) < 1e-4, "Re-bound batch output differs");
+    assertMsg(cv::norm(pair[1], expected[0], cv::NORM_INF) < 1e-4, "Re-bound batch output differs");
+    return true;
+}
+
+// Test 10: Tuned session options change how ORT runs, not what it computes
+bool test_session_config_same_output(const std::string& model_path) {
+    SessionConfig config;
+    config.intra_op_threads = 1;
+    config.graph_optimization = ORT_ENABLE_BASIC;
+    config.mem_pattern = false;
+    config.cpu_arena = false;
+    config.allow_spinning = false;
+    InferEngine tuned(model_path, config);
+    InferEngine plain(model_path);
+    assertMsg(tuned.getSessionConfig().intra_op_threads == 1, "Engine should keep the config it was loaded with");
+
+    cv::Mat frame(480, 640, CV_8UC3);
+    cv::randu(frame, 0, 255);
+    Preprocessor pre(plain.getInputWidth(), plain.getInputHeight());
+    const cv::Mat& blob = pre.process(frame);
+    cv::Mat expected = plain.infer(blob).clone();
+    //fewer graph fusions reorder float sums, so compare relative to the output range
+    const double tolerance = 1e-5 * std::max(1.0, cv::norm(expected, cv::NORM_INF));
+    assertMsg(cv::norm(tuned.infer(blob), expected, cv::NORM_INF) < tolerance, "Tuned session output differs");
+    assertMsg(tuned.withSharedSession()->getSessionConfig().intra_op_threads == 1, "Shared engines should report the session config");
+    return true;
+}
+
+// Test 11: The first load writes an optimized-model cache entry, the second loads it
+bool test_optimized_model_cache(const std::string& model_path) {
+    const std::filesystem::path cache_dir = std::filesystem::temp_directory_path() / "test_inferengine_cache";
+    std::filesystem::remove_all(cache_dir);
+    SessionConfig config;
+    config.optimized_model_dir = cache_dir.string();
+
+    const std::string entry = model_cache::entryPath(config.optimized_model_dir, model_path, config);
+    SessionConfig basic = config;
+    basic.graph_optimization = ORT_ENABLE_BASIC;
+    assertMsg(!entry.empty(), "Cache entry path should be derived from a readable model");
+    assertMsg(entry != model_cache::entryPath(config.optimized_model_dir, model_path, basic),
+              "Another optimization level should use another cache entry");
+
+    InferEngine first(model_path, config);
+    assertMsg(!first.loadedFromCache(), "An empty cache should not be hit");
+    assertMsg(std::filesystem::exists(entry), "The optimized model should be written to the cache");
+
+    InferEngine second(model_path, config);
+    assertMsg(second.loadedFromCache(), "The second load should use the cached model");
+
+    cv::Mat frame(480, 640, CV_8UC3);
+    cv::randu(frame, 0, 255);
+    Preprocessor pre(first.getInputWidth(), first.getInputHeight());
+    const cv::Mat& blob = pre.process(frame);
+    cv::Mat expected = first.infer(blob).clone();
+    assertMsg(cv::norm(second.infer(blob), expected, cv::NORM_INF) == 0, "Cached model output differs");
+
+    //a corrupt entry is not used; the raw model loads instead and replaces it
+    std::ofstream(entry, std::ios::trunc) << "not a model";
+    InferEngine third(model_path, config);
+    assertMsg(!third.loadedFromCache(), "A corrupt cache entry should not be used");
+    InferEngine fourth(model_path, config);
+    assertMsg(fourth.loadedFromCache(), "A corrupt cache entry should be replaced by the next load");
+
+    //a cache directory that cannot be created disables the cache, not the load
+    const std::filesystem::path blocker = cache_dir / "not_a_dir";
+    std::ofstream(blocker) << "file";
+    SessionConfig blocked = config;
+    blocked.optimized_model_dir = (blocker / "cache").string();
+    InferEngine fifth(model_path, blocked);
+    assertMsg(!fifth.loadedFromCache(), "An unusable cache directory should not be hit");
+    assertMsg(cv::norm(fifth.infer(blob), expected, cv::NORM_INF) == 0, "Model without its cache gives other output");
+
+    std::filesystem::remove_all(cache_dir);
+    return true;
+}
+
+// Test 12: Async requests in several slots give the same predictions as infer()
+bool test_infer_async_matches_sync(const std::string& model_path, int intra_op_threads) {
+    SessionConfig config;
+    config.intra_op_threads = intra_op_threads;
+    InferEngine engine(model_path, config);
+    Preprocessor pre(engine.getInputWidth(), engine.getInputHeight());
+
+    const size_t slots = 3;
+    engine.setAsyncSlots(slots);
+    std::vector<cv::Mat> frames, expected;
+    for (size_t i = 0; i < 2 * slots; ++i) {
+        cv::Mat frame(480, 640, CV_8UC3);
+        cv::randu(frame, 0, 255);
+        frames.push_back(frame);
+        expected.push_back(engine.infer(pre.process(frame)).clone());
+    }
+
+    //two rounds over every slot, so the second round reuses completed slots
+    std::atomic<int> callbacks{0};
+    for (size_t round = 0; round < 2; ++round) {
+        std::vector<std::future<cv::Mat>> results;
+        for (size_t s = 0; s < slots; ++s) {
+            pre.processInto(frames[round * slots + s], engine.asyncInputData(s));
+            results.push_back(engine.inferAsync(s, [&](size_t, const cv::Mat&) { callbacks++; }));
+        }
+        for (size_t s = 0; s < slots; ++s) {
+            cv::Mat preds = results[s].get();
+            assertMsg(preds.size() == expected[round * slots + s].size(), "Async output shape differs");
+            assertMsg(cv::norm(preds, expected[round * slots + s], cv::NORM_INF) < 1e-4, "Async output differs for slot " + std::to_string(s));
+        }
+    }
+    assertMsg(callbacks == static_cast<int>(2 * slots), "Every request should run its callback once");
+
+    //resubmitting a busy slot waits for it instead of clobbering it
+    for (int i = 0; i < 5; ++i) engine.inferAsync(0);
+    cv::Mat last = engine.inferAsync(0).get();
+    assertMsg(cv::norm(last, expected[slots], cv::NORM_INF) < 1e-4, "Back-to-back requests on one slot differ");
+    return true;
+}
+
+// Test 13: An INT8 export from quantize_model.py is detected and finds what the float one does
+bool test_quantized_model(const std::string& fp32_path, const std::string& int8_path) {
+    if (!std::ifstream(int8_path).good()) {
+        throw SkipTest(int8_path + " not found (make it with models/quantize_model.py)");
+    }
+    InferEngine fp32(fp32_path);
+    InferEngine int8(int8_path);
+    assertMsg(!fp32.isQuantized(), "A float model should not be reported as quantized");
+    assertMsg(int8.getQuantization() == "int8-static-qdq", "Quantization should be read from the model metadata");
+    assertMsg(int8.getInputDims() == fp32.getInputDims(), "Quantized model should keep the float input");
+
+    //grey road with car-sized blocks, so there is something to detect
+    cv::Mat frame(720, 1280, CV_8UC3, cv::Scalar(90, 90, 90));
+    cv::RNG rng(1);
+    for (int i = 0; i < 12; ++i) {
+        cv::Rect car(rng.uniform(0, 1150), rng.uniform(200, 650), rng.uniform(60, 130), rng.uniform(40, 70));
+        cv::rectangle(frame, car, cv::Scalar(rng.uniform(0, 255), rng.uniform(0, 255), rng.uniform(0, 255)), cv::FILLED);
+    }
+    Preprocessor pre(fp32.getInputWidth(), fp32.getInputHeight());
+    const cv::Mat& blob = pre.process(frame);
+    const auto [scale, padding] = pre.getScaleAndPadding();
+    cv::Mat expected = fp32.infer(blob).clone();
+    cv::Mat preds = int8.infer(blob);
+    assertMsg(preds.size() == expected.size(), "Quantized output shape differs");
+
+    //every float detection needs an int8 one of the same class, IoU >= 0.5 and a
+    //confidence within 0.15; a few boxes near the threshold may come and go
+    PostprocessConfig config;
+    config.conf_threshold = 0.1f;
+    Postprocessor post(config);
+    const std::vector<Detection> reference = post.process(expected, frame.size(), scale, padding);
+    const std::vector<Detection>& quantized = post.process(preds, frame.size(), scale, padding);
+    size_t matched = 0;
+    for (const auto& r : reference) {
+        for (const auto& q : quantized) {
+            const float inter = (r.box & q.box).area();
+            const float iou = inter / (r.box.area() + q.box.area() - inter);
+            if (q.cls == r.cls && iou >= 0.5f && std::abs(q.conf - r.conf) <= 0.15f) {
+                matched++;
+                break;
+            }
+        }
+    }
+    const size_t allowed_misses = std::max<size_t>(2, reference.size() / 5);
+    std::cout << "INT8 matched " << matched << " of " << reference.size() << " float detections ("
+              << quantized.size() << " int8 detections)" << std::endl;
+    assertMsg(matched + allowed_misses >= reference.size(), "Quantized detections differ from the float model");
+    assertMsg(quantized.size() <= reference.size() + allowed_misses, "Quantized model adds detections");
+    return true;
+}
+
+// Test 14: Mapped and in-memory loads compute the same as loading from the path
+bool test_mapped_and_buffer_load(const std::string& model_path) {
+    const std::filesystem::path cache_dir = std::filesystem::temp_directory_path() / "test_inferengine_mmap";
+    std::filesystem::remove_all(cache_dir);
+    SessionConfig mapped_config;
+    mapped_config.mmap_model = true;
+
+    InferEngine plain(model_path);
+    InferEngine mapped(model_path, mapped_config);
+
+    std::ifstream in(model_path, std::ios::binary);
+    const std::vector<char> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    InferEngine from_buffer;
+    assertMsg(from_buffer.loadModelFromBuffer(bytes.data(), bytes.size()), "Loading from a buffer should succeed");
+    assertMsg(!InferEngine().loadModelFromBuffer(bytes.data(), 16), "A truncated buffer should fail to load");
+
+    //an ORT format cache entry is mapped and its weights used in place
+    mapped_config.optimized_model_dir = cache_dir.string();
+    InferEngine(model_path, mapped_config);
+    ModelFile entry;
+    std::string error;
+    assertMsg(entry.map(model_cache::entryPath(cache_dir.string(), model_path, mapped_config), error), "Cache entry should map: " + error);
+    assertMsg(ModelFile::isOrtFormat(entry.data(), entry.size()), "Cache entries are ORT format");
+    assertMsg(!ModelFile::isOrtFormat(bytes.data(), bytes.size()), "The ONNX export is not ORT format");
+    auto cached = std::make_unique<InferEngine>(model_path, mapped_config);
+    assertMsg(cached->loadedFromCache(), "The mapped load should use the cache entry");
+    auto shared = cached->withSharedSession();
+    cached.reset();  //the shared engine keeps the mapping alive
+
+    cv::Mat frame(480, 640, CV_8UC3);
+    cv::randu(frame, 0, 255);
+    Preprocessor pre(plain.getInputWidth(), plain.getInputHeight());
+    const cv::Mat& blob = pre.process(frame);
+    cv::Mat expected = plain.infer(blob).clone();
+    assertMsg(cv::norm(mapped.infer(blob), expected, cv::NORM_INF) == 0, "Mapped model output differs");
+    assertMsg(cv::norm(from_buffer.infer(blob), expected, cv::NORM_INF) == 0, "Buffer model output differs");
+    const double tolerance = 1e-5 * std::max(1.0, cv::norm(expected, cv::NORM_INF));
+    assertMsg(cv::norm(shared->infer(blob), expected, cv::NORM_INF) < tolerance, "Mapped cache entry output differs");
+
+    std::filesystem::remove_all(cache_dir);
+    return true;
+}
+
+// Test 15: Warm-up at load leaves the engine computing the same output
+bool test_warmup_keeps_output(const std::string& model_path) {
+    SessionConfig config;
+    config.warmup_runs = 2;
+    config.warmup_batch = 2;
+    InferEngine warm(model_path, config);
+    InferEngine plain(model_path);
+
+    cv::Mat frame(480, 640, CV_8UC3);
+    cv::randu(frame, 0, 255);
+    Preprocessor pre(plain.getInputWidth(), plain.getInputHeight());
+    const cv::Mat& blob = pre.process(frame);
+    cv::Mat expected = plain.infer(blob).clone();
+    assertMsg(cv::norm(warm.infer(blob), expected, cv::NORM_INF) == 0, "Warmed-up engine output differs");
+
+    //warm-up on demand after the load, and a no-op without runs
+    plain.warmUp(1);
+    plain.warmUp(0);
+    assertMsg(cv::norm(plain.infer(blob), expected, cv::NORM_INF) == 0, "Output differs after warmUp()");
+    return true;
+}
+
 int main() {
     std::string model_path = "yolov8n.onnx";
     std::ifstream f(model_path);
@@ -102,6 +455,7 @@ int main() {
 
     int passed = 0;
     int total = 0;
+    int skipped = 0;
 
     auto run_test = [&](auto test_func, const std::string& name) {
         total++;
@@ -110,6 +464,10 @@ int main() {
                 std::cout << "[PASS] " << name << std::endl;
                 passed++;
             }
+        } catch (const SkipTest& e) {
+            std::cout << "[SKIP] " << name << " : " << e.what() << std::endl;
+            total--;
+            skipped++;
         } catch (const std::exception& e) {
         } catch (...) {
             std::cerr << "[FAIL] " << name << " : Unknown exception" << std::endl;
@@ -121,7 +479,21 @@ int main() {
     run_test([&](){ return test_infer_with_empty_blob(model_path); }, "Infer with empty blob");
     run_test([&](){ return test_infer_on_valid_blob(model_path); }, "Infer on valid blob");
     run_test([&](){ return test_infer_with_real_image(model_path); }, "Infer with real image preprocessing");
+    run_test([&](){ return test_zero_copy_input(model_path); }, "Zero-copy preprocessing into input tensor");
+    run_test([&](){ return test_model_input_size_from_model("yolov8n_320.onnx"); }, "Input size read from a 320 export");
+    run_test([&](){ return test_repeated_inference_no_growth(model_path); }, "1000 inferences without allocation growth");
+    run_test([&](){ return test_infer_batch_matches_single("yolov8n_dyn.onnx"); }, "Batched inference on a dynamic-batch export");
+    run_test([&](){ return test_infer_batch_matches_single(model_path); }, "Batched inference falls back on a batch-1 export");
+    run_test([&](){ return test_session_config_same_output(model_path); }, "Tuned session options keep the output");
+    run_test([&](){ return test_optimized_model_cache(model_path); }, "Optimized-model cache round trip");
+    run_test([&](){ return test_infer_async_matches_sync(model_path, 2); }, "Async inference on the ORT pool");
+    run_test([&](){ return test_infer_async_matches_sync(model_path, 1); }, "Async inference on the executor fallback");
+    run_test([&](){ return test_quantized_model(model_path, "yolov8n_int8_static.onnx"); }, "INT8 model detected and run");
+    run_test([&](){ return test_mapped_and_buffer_load(model_path); }, "Mapped and in-memory model loading");
+    run_test([&](){ return test_warmup_keeps_output(model_path); }, "Warm-up at model load");
 
-    std::cout << "\n=== Test Summary: " << passed << " / " << total << " passed ===" << std::endl;
+    std::cout << "\n=== Test Summary: " << passed << " / " << total << " passed";
+    if (skipped > 0) std::cout << ", " << skipped << " skipped";
+    std::cout << " ===" << std::endl;
     return (passed == total) ? 0 : 1;
 }
@@ -0,0 +1,146 @@
+#include <iostream>
+#include <thread>
+#include <vector>
+#include <sstream>
+#include <cstdlib>
+#include "../headers/metrics.h"
+
+using namespace std;
+
+#define LOG(...) do { cerr << __VA_ARGS__ << endl; } while(0)
+#define RUN_TEST(fn) \
+    do { \
+        cout << "Running " << #fn << " ... "; \
+        bool ok = fn(); \
+        if (ok) cout << "[PASS]\n"; else cout << "[FAIL]\n"; \
+        total++; if (ok) passed++; \
+    } while(0)
+
+// ---------------- Tests ----------------
+
+bool test_bucket_bounds_cover_values() {
+    //every value must land in a bucket whose upper bound is >= the value and within ~1.6%
+    for (uint64_t v : {0ull, 1ull, 127ull, 128ull, 129ull, 1000ull, 33333333ull, 1ull << 39}) {
+        size_t idx = LatencyHistogram::bucketIndex(v);
+        uint64_t upper = LatencyHistogram::bucketUpperBound(idx);
+        if (idx >= LatencyHistogram::kBucketCount) { LOG("index out of range for " << v); return false; }
+        if (upper < v || upper - v > v / 60 + 1) { LOG("bucket for " << v << " ends at " << upper); return false; }
+        if (idx > 0 && LatencyHistogram::bucketUpperBound(idx - 1) >= v) { LOG("buckets overlap at " << v); return false; }
+    }
+    return LatencyHistogram::bucketIndex(~0ull) == LatencyHistogram::kBucketCount - 1;
+}
+
+bool test_percentiles_of_uniform_samples() {
+    Metrics metrics;
+    ThreadMetrics& tm = metrics.local();
+    //1..10000 microseconds
+    for (int i = 1; i <= 10000; ++i) tm.record(Stage::Inference, chrono::microseconds(i));
+
+    HistogramSnapshot snap = metrics.stage(Stage::Inference);
+    auto near = [](uint64_t got_ns, double want_us) {
+        return abs(got_ns / 1e3 - want_us) <= want_us * 0.02;
+    };
+    if (snap.count() != 10000) { LOG("count " << snap.count()); return false; }
+    if (!near(snap.percentile(0.50), 5000)) { LOG("p50 " << snap.percentile(0.50)); return false; }
+    if (!near(snap.percentile(0.90), 9000)) { LOG("p90 " << snap.percentile(0.90)); return false; }
+    if (!near(snap.percentile(0.99), 9900)) { LOG("p99 " << snap.percentile(0.99)); return false; }
+    return snap.max() == 10000000 && snap.percentile(1.0) == snap.max();
+}
+
+bool test_threads_merge() {
+    Metrics metrics;
+    const int threads = 4, per_thread = 5000;
+    vector<thread> pool;
+    for (int t = 0; t < threads; ++t) {
+        pool.emplace_back([&] {
+            ThreadMetrics& tm = metrics.local();
+            for (int i = 0; i < per_thread; ++i) {
+                tm.record(Stage::Preprocess, chrono::nanoseconds(1000));
+                tm.add(Counter::FramesProcessed);
+            }
+        });
+    }
+    for (auto& t : pool) t.join();
+    return metrics.counter(Counter::FramesProcessed) == uint64_t(threads * per_thread) &&
+           metrics.stage(Stage::Preprocess).count() == uint64_t(threads * per_thread);
+}
+
+bool test_local_is_per_instance() {
+    //a thread switching to a new Metrics must not keep writing into the old one
+    auto first = make_unique<Metrics>();
+    first->local().add(Counter::FramesDecoded);
+    first.reset();
+    Metrics second;
+    second.local().add(Counter::FramesDecoded, 2);
+    return second.counter(Counter::FramesDecoded) == 2;
+}
+
+bool test_local_survives_switching() {
+    //alternating between two live instances reuses each one's block
+    Metrics a, b;
+    ThreadMetrics* first_a = &a.local();
+    ThreadMetrics* first_b = &b.local();
+    for (int i = 0; i < 100; ++i) {
+        if (&a.local() != first_a || &b.local() != first_b) { LOG("block re-registered on switch " << i); return false; }
+        a.local().add(Counter::FramesDecoded);
+        b.local().add(Counter::FramesDecoded, 2);
+    }
+    return a.counter(Counter::FramesDecoded) == 100 && b.counter(Counter::FramesDecoded) == 200;
+}
+
+bool test_scoped_timer_records() {
+    Metrics metrics;
+    {
+        ScopedStageTimer timer(metrics.local(), Stage::Draw);
+        this_thread::sleep_for(chrono::milliseconds(2));
+    }
+    HistogramSnapshot snap = metrics.stage(Stage::Draw);
+    return snap.count() == 1 && snap.max() >= 2000000;
+}
+
+bool test_restart_clock_resets_uptime() {
+    Metrics m;
+    this_thread::sleep_for(chrono::milliseconds(50));
+    const double before = m.uptime();
+    m.restartClock();
+    const double after = m.uptime();
+    if (before < 0.05 || after >= 0.05) { LOG("uptime " << before << "s before restart, " << after << "s after"); return false; }
+    return after >= 0.0;
+}
+
+bool test_reporter_writes_json_lines() {
+    Metrics metrics;
+    metrics.local().add(Counter::FramesProcessed, 3);
+    metrics.local().record(Stage::Encode, chrono::milliseconds(1));
+
+    ostringstream out;
+    {
+        MetricsReporter reporter(metrics, out, chrono::milliseconds(5));
+        this_thread::sleep_for(chrono::milliseconds(30));
+    }
+    string text = out.str();
+    size_t lines = 0;
+    for (char c : text) if (c == '\n') lines++;
+    if (lines < 2) { LOG("expected periodic and final reports, got " << lines << " lines"); return false; }
+    if (text.find("\"final\":true") == string::npos) { LOG("missing final report"); return false; }
+    for (const char* key : {"\"fps\":", "\"frames_processed\":3", "\"encode\":{\"count\":1", "\"p99_ms\":", "\"queue_wait\""}) {
+        if (text.find(key) == string::npos) { LOG("missing " << key << " in " << text); return false; }
+    }
+    return true;
+}
+
+int main() {
+    int passed = 0, total = 0;
+    RUN_TEST(test_bucket_bounds_cover_values);
+    RUN_TEST(test_percentiles_of_uniform_samples);
+    RUN_TEST(test_threads_merge);
+    RUN_TEST(test_local_is_per_instance);
+    RUN_TEST(test_local_survives_switching);
+    RUN_TEST(test_scoped_timer_records);
+    RUN_TEST(test_restart_clock_resets_uptime);
+    RUN_TEST(test_reporter_writes_json_lines);
+
+    cout << "----------------------------------------\n";
+    cout << "Test summary: Passed " << passed << " / " << total << " tests\n";
+    return (passed == total) ? 0 : 1;
+}
@@ -2,6 +2,33 @@
 #include <vector>
 #include "../headers/nms.h"
 
+// Crowded candidates as a low --conf threshold produces them: clusters of jittered
+// boxes around a few objects, spread over several classes, plus scattered noise.
+static std::vector<Detection> crowded(int n, int classes, unsigned seed) {
+    cv::RNG rng(seed);
+    std::vector<Detection> dets;
+    while (static_cast<int>(dets.size()) < n) {
+        const float cx = rng.uniform(0.0f, 1280.0f), cy = rng.uniform(0.0f, 720.0f);
+        const float w = rng.uniform(10.0f, 200.0f), h = rng.uniform(10.0f, 150.0f);
+        const int cls = rng.uniform(0, classes);
+        for (int k = 0; k < 20 && static_cast<int>(dets.size()) < n; ++k) {
+            const float jx = rng.uniform(-0.3f, 0.3f) * w, jy = rng.uniform(-0.3f, 0.3f) * h;
+            //quantized scores, so equal confidences occur as they do in real heads
+            const float conf = static_cast<int>(rng.uniform(0.05f, 1.0f) * 64) / 64.0f;
+            dets.push_back({cv::Rect2f(cx + jx - w / 2, cy + jy - h / 2, w, h), conf, cls});
+        }
+    }
+    return dets;
+}
+
+static bool same_detections(const std::vector<Detection>& a, const std::vector<Detection>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a[i].box != b[i].box || a[i].conf != b[i].conf || a[i].cls != b[i].cls) return false;
+    }
+    return true;
+}
+
 int main() {
     using namespace std;
 
@@ -41,6 +68,75 @@ int main() {
             cout << "[TEST4] " << (res.size() == 2 ? "PASS" : "FAIL") << "\n";
         }
 
+        // --- Test 5: Letterbox geometry from the preprocessor (1280x720 -> scale 0.5, pad y 140) ---
+        {
+            cv::Mat preds(1, 84, CV_32F, cv::Scalar(0));
+            preds.at<float>(0,0) = 320; preds.at<float>(0,1) = 320; preds.at<float>(0,2) = 100; preds.at<float>(0,3) = 50; preds.at<float>(0,4) = 0.9f;
+            auto res = postprocess(preds, {1280,720}, 0.5f, cv::Point(0, 140), 0.5f, 0.5f);
+            bool ok = res.size() == 1 && res[0].box == cv::Rect2f(540, 310, 200, 100);
+            cout << "[TEST5] " << (ok ? "PASS" : "FAIL") << "\n";
+        }
+
+        // --- Test 6: Grid NMS keeps exactly what the all-pairs NMS keeps, in the same order ---
+        {
+            bool ok = true;
+            GridNms grid;  //reused, as the consumers do
+            for (int n : {1000, 2000, 4000, 8000}) {
+                for (int classes : {1, 3, 80}) {
+                    for (float iou : {0.0f, 0.45f, 0.7f}) {
+                        std::vector<Detection> expected = crowded(n, classes, n + classes);
+                        std::vector<Detection> actual = expected;
+                        applyNMS(expected, iou);
+                        grid.apply(actual, iou);
+                        if (!same_detections(expected, actual)) {
+                            cerr << "grid NMS differs: n=" << n << " classes=" << classes << " iou=" << iou << "\n";
+                            ok = false;
+                        }
+                    }
+                }
+            }
+            cout << "[TEST6] " << (ok ? "PASS" : "FAIL") << "\n";
+        }
+
+        // --- Test 7: Grid NMS edge cases: empty input, one box, identical boxes ---
+        {
+            GridNms grid;
+            std::vector<Detection> none;
+            grid.apply(none, 0.45f);
+            std::vector<Detection> one = {{cv::Rect2f(5, 5, 10, 10), 0.9f, 2}};
+            grid.apply(one, 0.45f);
+            std::vector<Detection> stacked(5, {cv::Rect2f(100, 100, 40, 40), 0.5f, 1});
+            grid.apply(stacked, 0.45f);
+            bool ok = none.empty() && one.size() == 1 && stacked.size() == 1;
+            cout << "[TEST7] " << (ok ? "PASS" : "FAIL") << "\n";
+        }
+
+        // --- Test 8: Top-K and max-detections caps keep the most confident boxes ---
+        {
+            //2000 disjoint 10x10 boxes, all above the threshold, with distinct scores
+            const int n = 2000;
+            cv::Mat preds(n, 84, CV_32F, cv::Scalar(0));
+            for (int i = 0; i < n; ++i) {
+                preds.at<float>(i, 0) = 10.0f + 16.0f * (i % 40);
+                preds.at<float>(i, 1) = 10.0f + 16.0f * (i / 40);
+                preds.at<float>(i, 2) = 10; preds.at<float>(i, 3) = 10;
+                preds.at<float>(i, 4 + i % 4) = 0.3f + 0.6f * i / n;
+            }
+            PostprocessConfig config;
+            config.conf_threshold = 0.25f;
+            config.top_k = 0;
+            config.max_det = 0;
+            auto all = postprocess(preds, {640, 820}, 1.0f, cv::Point(0, 0), config);
+            config.top_k = 100;
+            auto top = postprocess(preds, {640, 820}, 1.0f, cv::Point(0, 0), config);
+            config.max_det = 10;
+            auto capped = postprocess(preds, {640, 820}, 1.0f, cv::Point(0, 0), config);
+            bool ok = all.size() == static_cast<size_t>(n) && top.size() == 100 && capped.size() == 10;
+            for (size_t i = 0; ok && i < top.size(); ++i) ok = top[i].conf == all[i].conf;
+            for (size_t i = 0; ok && i < capped.size(); ++i) ok = capped[i].conf == all[i].conf;
+            cout << "[TEST8] " << (ok ? "PASS" : "FAIL") << "\n";
+        }
+
     } catch (...) {
         cerr << "Error: test failed\n";
         return 1;
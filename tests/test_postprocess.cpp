@@ -0,0 +1,107 @@
+#include <iostream>
+#include <vector>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <opencv2/opencv.hpp>
+#include "../headers/postprocess.h"
+
+using namespace std;
+
+// Heap allocations made so far, so steady-state postprocessing can be checked for none.
+static atomic<long> g_allocations{0};
+
+void* operator new(size_t n) {
+    g_allocations++;
+    if (void* p = malloc(n ? n : 1)) return p;
+    throw bad_alloc();
+}
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+
+#define LOG(...) do { cerr << __VA_ARGS__ << endl; } while(0)
+#define RUN_TEST(fn) \
+    do { \
+        cout << "Running " << #fn << " ... "; \
+        bool ok = fn(); \
+        if (ok) cout << "[PASS]\n"; else cout << "[FAIL]\n"; \
+        total++; if (ok) passed++; \
+    } while(0)
+
+// Channel-major [84, 8400] head with `hot` anchors in ten scoring above 0.25, in
+// clusters, so NMS has overlapping boxes to suppress.
+static cv::Mat random_head(int hot, uint64_t seed) {
+    cv::RNG rng(seed);
+    cv::Mat head(84, 8400, CV_32F);
+    rng.fill(head.rowRange(0, 2), cv::RNG::UNIFORM, 0.0f, 640.0f);
+    rng.fill(head.rowRange(2, 4), cv::RNG::UNIFORM, 10.0f, 120.0f);
+    rng.fill(head.rowRange(4, 84), cv::RNG::UNIFORM, 0.0f, 0.05f);
+    for (int a = 0; a < 8400; ++a) {
+        if (rng.uniform(0, 10) < hot) head.at<float>(4 + rng.uniform(0, 4), a) = rng.uniform(0.3f, 1.0f);
+    }
+    return head;
+}
+
+// ---------------- Tests ----------------
+
+bool test_steady_state_does_not_allocate() {
+    //heads of varying density and layout, made before counting
+    vector<cv::Mat> heads;
+    for (int i = 0; i < 40; ++i) heads.push_back(random_head(i % 10, 100 + i));
+    PostprocessConfig config;
+    config.top_k = 0;  //every candidate through NMS, the largest working set
+    Postprocessor post(config);
+
+    //only the first frame sizes the buffers, and it is the sparsest one
+    post.process(heads[0], {1280, 720}, 0.5f, cv::Point(0, 140));
+
+    const long before = g_allocations.load();
+    size_t found = 0;
+    for (const cv::Mat& head : heads) {
+        found += post.process(head, {1280, 720}, 0.5f, cv::Point(0, 140)).size();
+    }
+    const long allocations = g_allocations.load() - before;
+    if (allocations != 0) { LOG(allocations << " allocations in " << heads.size() << " frames"); return false; }
+    return found > 0;
+}
+
+bool test_matches_postprocess() {
+    const cv::Mat head = random_head(3, 3);
+    PostprocessConfig config;
+    config.conf_threshold = 0.3f;
+    config.max_det = 50;
+    Postprocessor post(config);
+    vector<Detection> into;
+    post.processInto(head, LetterboxMap{0.5f, 0.0f, 140.0f, cv::Size(1280, 720)}, into);
+    const auto expected = postprocess(head, {1280, 720}, 0.5f, cv::Point(0, 140), config);
+    const auto& owned = post.process(head, {1280, 720}, 0.5f, cv::Point(0, 140));
+    if (expected.empty() || expected.size() != into.size() || expected.size() != owned.size()) {
+        LOG("sizes " << expected.size() << ", " << into.size() << ", " << owned.size());
+        return false;
+    }
+    for (size_t i = 0; i < expected.size(); ++i) {
+        if (expected[i].box != into[i].box || expected[i].conf != owned[i].conf || expected[i].cls != owned[i].cls) {
+            LOG("detection " << i << " differs");
+            return false;
+        }
+    }
+    return true;
+}
+
+bool test_bad_shape_leaves_output_empty() {
+    Postprocessor post;
+    vector<Detection> out(3);
+    const bool ok = post.processInto(cv::Mat(50, 100, CV_32F, cv::Scalar(0)), LetterboxMap{}, out);
+    return !ok && out.empty();
+}
+
+int main() {
+    int passed = 0, total = 0;
+    RUN_TEST(test_steady_state_does_not_allocate);
+    RUN_TEST(test_matches_postprocess);
+    RUN_TEST(test_bad_shape_leaves_output_empty);
+
+    cout << "----------------------------------------\n";
+    cout << "Test summary: Passed " << passed << " / " << total << " tests\n";
+    return (passed == total) ? 0 : 1;
+}
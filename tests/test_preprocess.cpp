@@ -1,9 +1,25 @@
 #include <iostream>
 #include <cmath>
 #include <vector>
+#include <cstring>
+#include <cstdlib>
+#include <atomic>
+#include <new>
 #include <opencv2/opencv.hpp>
 #include "../headers/preprocess.h" 
 
+// Counts every global operator new so the workspace test can assert steady-state
+// preprocessing never allocates.
+static std::atomic<size_t> g_allocations{0};
+
+void* operator new(size_t n) {
+    g_allocations++;
+    if (void* p = malloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+
 static void assertMsg(bool cond, const std::string &msg) {
     if (!cond) {
         std::cerr << "[FAIL] " << msg << std::endl;
@@ -11,6 +27,44 @@ static void assertMsg(bool cond, const std::string &msg) {
     }
 }
 
+// The multi-pass OpenCV pipeline Preprocessor::process used before the fused kernel;
+// the kernel must reproduce it bit for bit.
+static cv::Mat reference_blob(const cv::Mat &frame, int input_w, int input_h) {
+    float scale = std::min(static_cast<float>(input_w) / frame.cols, static_cast<float>(input_h) / frame.rows);
+    int new_w = static_cast<int>(frame.cols * scale);
+    int new_h = static_cast<int>(frame.rows * scale);
+
+    cv::Mat resized;
+    cv::resize(frame, resized, cv::Size(new_w, new_h));
+    cv::Mat letterboxed(input_h, input_w, frame.type(), cv::Scalar(114, 114, 114));
+    resized.copyTo(letterboxed(cv::Rect((input_w - new_w) / 2, (input_h - new_h) / 2, new_w, new_h)));
+
+    cv::Mat rgb, float_img;
+    cv::cvtColor(letterboxed, rgb, cv::COLOR_BGR2RGB);
+    rgb.convertTo(float_img, CV_32F, 1.0 / 255.0);
+    std::vector<cv::Mat> channels(3);
+    cv::split(float_img, channels);
+
+    cv::Mat blob_1d(1, 3 * input_h * input_w, CV_32F);
+    for (int c = 0; c < 3; ++c) {
+        std::memcpy(blob_1d.ptr<float>(0) + c * input_h * input_w, channels[c].ptr<float>(0),
+                    input_h * input_w * sizeof(float));
+    }
+    return blob_1d;
+}
+
+static void assertBitExact(const cv::Mat &blob, const cv::Mat &ref, const std::string &name) {
+    const size_t bytes = ref.total() * sizeof(float);
+    assertMsg(blob.total() * blob.elemSize() == bytes, name + ": blob size differs from the reference.");
+    if (std::memcmp(blob.ptr<float>(), ref.ptr<float>(), bytes) != 0) {
+        const float *a = blob.ptr<float>(), *b = ref.ptr<float>();
+        size_t i = 0;
+        while (a[i] == b[i]) ++i;
+        assertMsg(false, name + ": blob differs from the reference at element " + std::to_string(i) +
+                         " (" + std::to_string(a[i]) + " vs " + std::to_string(b[i]) + ")");
+    }
+}
+
 struct CaseResult { std::string name; bool ok; std::string msg; };
 
 CaseResult run_case(const std::string &name, int orig_w, int orig_h, int input_w = 640, int input_h = 640) {
@@ -28,6 +82,14 @@ CaseResult run_case(const std::string &name, int orig_w, int orig_h, int input_w
                   "), but got " + std::to_string(blob.size[2]) + "x" + std::to_string(blob.size[3]));
         assertMsg(blob.depth() == CV_32F, name + ": Expected blob data type to be CV_32F (float).");
 
+        //fused kernel, SIMD and scalar, against the original multi-pass pipeline
+        cv::Mat ref = reference_blob(img, input_w, input_h);
+        assertBitExact(blob, ref, name + (prep.simdEnabled() ? " (simd)" : " (scalar)"));
+        if (prep.simdEnabled()) {
+            prep.useSimd(false);
+            assertBitExact(prep.process(img), ref, name + " (scalar)");
+        }
+
         // --- Removed Tests ---
         // All tests related to 'getScaleAndPadding' and coordinate transformations
         // have been removed, as that logic is no longer part of the preprocessor.
@@ -40,6 +102,55 @@ CaseResult run_case(const std::string &name, int orig_w, int orig_h, int input_w
     }
 }
 
+// Geometry is cached per source resolution and the blob buffer is reused across frames.
+CaseResult run_workspace_case() {
+    const std::string name = "workspace_reuse";
+    try {
+        Preprocessor prep(640, 640);
+        auto geometry = prep.getScaleAndPadding();
+        assertMsg(geometry.first == 1.0f && geometry.second == cv::Point(0, 0), name + ": unexpected geometry before first frame.");
+
+        cv::Mat hd(720, 1280, CV_8UC3), hd2(720, 1280, CV_8UC3), square(640, 640, CV_8UC3);
+        cv::randu(hd, 0, 255);
+        cv::randu(hd2, 0, 255);
+        cv::randu(square, 0, 255);
+
+        const float* data = prep.process(hd).ptr<float>();
+        geometry = prep.getScaleAndPadding();
+        assertMsg(geometry.first == 0.5f && geometry.second == cv::Point(0, 140),
+                  name + ": expected scale 0.5 and padding (0, 140) for 1280x720.");
+
+        //same resolution: same buffer, padding left intact, content rewritten
+        const cv::Mat& blob = prep.process(hd2);
+        assertMsg(blob.ptr<float>() == data, name + ": blob was reallocated for an unchanged resolution.");
+        assertBitExact(blob, reference_blob(hd2, 640, 640), name + " (hd2)");
+
+        //resolution change re-plans geometry and padding
+        assertBitExact(prep.process(square), reference_blob(square, 640, 640), name + " (square)");
+        geometry = prep.getScaleAndPadding();
+        assertMsg(geometry.first == 1.0f && geometry.second == cv::Point(0, 0), name + ": geometry not re-planned.");
+        assertBitExact(prep.process(hd), reference_blob(hd, 640, 640), name + " (back to hd)");
+
+        //steady state on a frame at model resolution touches no allocator at all
+        prep.process(square);
+        size_t before = g_allocations.load();
+        for (int i = 0; i < 20; ++i) prep.process(square);
+        size_t allocations = g_allocations.load() - before;
+        assertMsg(allocations == 0, name + ": steady state performed " + std::to_string(allocations) + " allocations.");
+
+        //the same holds on the resize-and-pad path, alternating frames of one resolution
+        prep.process(hd);
+        before = g_allocations.load();
+        for (int i = 0; i < 20; ++i) prep.process(i % 2 ? hd : hd2);
+        allocations = g_allocations.load() - before;
+        assertMsg(allocations == 0, name + ": 1280x720 steady state performed " + std::to_string(allocations) + " allocations.");
+
+        return {name, true, "OK"};
+    } catch (const std::exception &ex) {
+        return {name, false, ex.what()};
+    }
+}
+
 int main() {
     std::vector<std::tuple<std::string,int,int>> cases = {
         {"standard_640x480", 640, 480},
@@ -49,6 +160,7 @@ int main() {
         {"tall_200x1000", 200, 1000},
         {"tiny_1x1", 1, 1},
         {"odd_dims_123x321", 123, 321},
+        {"odd_dims_1283x719", 1283, 719},
     };
 
     int total = 0, passed = 0;
@@ -62,6 +174,29 @@ int main() {
         }
     }
 
+    //non-square model input
+    total++;
+    auto res = run_case("model_320x192_from_640x480", 640, 480, 320, 192);
+    if (res.ok) {
+        std::cout << "[PASS] " << res.name << " : " << res.msg << std::endl;
+        passed++;
+    }
+
+    total++;
+    res = run_workspace_case();
+    if (res.ok) {
+        std::cout << "[PASS] " << res.name << " : " << res.msg << std::endl;
+        passed++;
+    }
+
+    //non-BGR input is rejected instead of throwing from cvtColor
+    total++;
+    Preprocessor prep;
+    if (prep.process(cv::Mat(10, 10, CV_8UC1, cv::Scalar(0))).empty()) {
+        std::cout << "[PASS] rejects_non_bgr : OK" << std::endl;
+        passed++;
+    }
+
     std::cout << "\n=== Test Summary: " << passed << " / " << total << " passed ===" << std::endl;
     return (passed == total) ? 0 : 1;
-}
\ No newline at end of file
+}
\ No newline at end of file
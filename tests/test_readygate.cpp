@@ -0,0 +1,65 @@
+#include <iostream>
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include "../headers/ready_gate.h"
+
+using namespace std;
+
+#define LOG(...) do { cerr << __VA_ARGS__ << endl; } while(0)
+#define RUN_TEST(fn) \
+    do { \
+        cout << "Running " << #fn << " ... "; \
+        bool ok = fn(); \
+        if (ok) cout << "[PASS]\n"; else cout << "[FAIL]\n"; \
+        total++; if (ok) passed++; \
+    } while(0)
+
+// ---------------- Tests ----------------
+
+bool test_wait_blocks_until_open() {
+    ReadyGate gate;
+    atomic<bool> released{false};
+    atomic<bool> result{false};
+    thread waiter([&] { result = gate.wait(); released = true; });
+
+    this_thread::sleep_for(chrono::milliseconds(20));
+    if (released) { LOG("wait returned before open"); waiter.detach(); return false; }
+    gate.open();
+    waiter.join();
+    return result && gate.isOpen();
+}
+
+bool test_fail_releases_waiters() {
+    ReadyGate gate;
+    vector<thread> waiters;
+    atomic<int> opened{0}, released{0};
+    for (int i = 0; i < 3; ++i) {
+        waiters.emplace_back([&] { if (gate.wait()) opened++; released++; });
+    }
+    this_thread::sleep_for(chrono::milliseconds(10));
+    gate.fail();
+    for (auto& t : waiters) t.join();
+    return released == 3 && opened == 0 && !gate.isOpen();
+}
+
+bool test_first_outcome_sticks() {
+    ReadyGate opened, failed;
+    opened.open();
+    opened.fail();
+    failed.fail();
+    failed.open();
+    return opened.wait() && !failed.wait();
+}
+
+int main() {
+    int passed = 0, total = 0;
+    RUN_TEST(test_wait_blocks_until_open);
+    RUN_TEST(test_fail_releases_waiters);
+    RUN_TEST(test_first_outcome_sticks);
+
+    cout << "----------------------------------------\n";
+    cout << "Test summary: Passed " << passed << " / " << total << " tests\n";
+    return (passed == total) ? 0 : 1;
+}
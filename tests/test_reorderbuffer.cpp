@@ -0,0 +1,100 @@
+#include <iostream>
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <opencv2/opencv.hpp>
+#include "../headers/reorder_buffer.h"
+
+using namespace std;
+
+#define LOG(...) do { cerr << __VA_ARGS__ << endl; } while(0)
+#define RUN_TEST(fn) \
+    do { \
+        cout << "Running " << #fn << " ... "; \
+        bool ok = fn(); \
+        if (ok) cout << "[PASS]\n"; else cout << "[FAIL]\n"; \
+        total++; if (ok) passed++; \
+    } while(0)
+
+cv::Mat tagged(int tag) {
+    cv::Mat m(1, 1, CV_32S);
+    m.at<int>(0, 0) = tag;
+    return m;
+}
+
+// ---------------- Tests ----------------
+
+bool test_in_order_passes_through() {
+    vector<int> out;
+    ReorderBuffer rb([&](const cv::Mat& f) { out.push_back(f.at<int>(0, 0)); });
+    for (int i = 0; i < 5; ++i) rb.submit(i, tagged(i));
+    return out == vector<int>({0, 1, 2, 3, 4}) && rb.pending() == 0 && rb.nextSeq() == 5;
+}
+
+bool test_out_of_order_is_held_back() {
+    vector<int> out;
+    ReorderBuffer rb([&](const cv::Mat& f) { out.push_back(f.at<int>(0, 0)); });
+    rb.submit(2, tagged(2));
+    rb.submit(1, tagged(1));
+    if (!out.empty() || rb.pending() != 2) { LOG("results released before seq 0"); return false; }
+    rb.submit(0, tagged(0));
+    rb.submit(4, tagged(4));
+    if (out != vector<int>({0, 1, 2}) || rb.pending() != 1) { LOG("flush after seq 0 was wrong"); return false; }
+    rb.submit(3, tagged(3));
+    return out == vector<int>({0, 1, 2, 3, 4}) && rb.pending() == 0;
+}
+
+bool test_empty_frames_keep_their_slot() {
+    int calls = 0, empties = 0;
+    ReorderBuffer rb([&](const cv::Mat& f) { calls++; if (f.empty()) empties++; });
+    rb.submit(1, tagged(1));
+    rb.submit(0, cv::Mat());
+    return calls == 2 && empties == 1;
+}
+
+bool test_duplicate_is_ignored() {
+    int calls = 0;
+    ReorderBuffer rb([&](const cv::Mat&) { calls++; });
+    rb.submit(0, tagged(0));
+    rb.submit(0, tagged(0));
+    return calls == 1 && rb.nextSeq() == 1;
+}
+
+bool test_concurrent_workers_produce_ordered_output() {
+    const int n = 2000, workers = 4;
+    vector<int> out;
+    ReorderBuffer rb([&](const cv::Mat& f) { out.push_back(f.at<int>(0, 0)); });
+
+    //workers claim sequence numbers in order but finish them at different speeds
+    atomic<int> next{0};
+    vector<thread> threads;
+    for (int w = 0; w < workers; ++w) {
+        threads.emplace_back([&, w] {
+            int seq;
+            while ((seq = next++) < n) {
+                if ((seq + w) % 7 == 0) this_thread::yield();
+                rb.submit(seq, tagged(seq));
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+
+    if (static_cast<int>(out.size()) != n) { LOG("expected " << n << " frames, got " << out.size()); return false; }
+    for (int i = 0; i < n; ++i) {
+        if (out[i] != i) { LOG("frame " << out[i] << " written at position " << i); return false; }
+    }
+    return rb.pending() == 0;
+}
+
+int main() {
+    int passed = 0, total = 0;
+    RUN_TEST(test_in_order_passes_through);
+    RUN_TEST(test_out_of_order_is_held_back);
+    RUN_TEST(test_empty_frames_keep_their_slot);
+    RUN_TEST(test_duplicate_is_ignored);
+    RUN_TEST(test_concurrent_workers_produce_ordered_output);
+
+    cout << "----------------------------------------\n";
+    cout << "Test summary: Passed " << passed << " / " << total << " tests\n";
+    return (passed == total) ? 0 : 1;
+}
@@ -0,0 +1,122 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <cstdio>
+#include "../headers/session_config.h"
+
+using namespace std;
+
+#define LOG(...) do { cerr << __VA_ARGS__ << endl; } while(0)
+#define RUN_TEST(fn) \
+    do { \
+        cout << "Running " << #fn << " ... "; \
+        bool ok = fn(); \
+        if (ok) cout << "[PASS]\n"; else cout << "[FAIL]\n"; \
+        total++; if (ok) passed++; \
+    } while(0)
+
+static string writeTemp(const string& name, const string& contents) {
+    ofstream(name) << contents;
+    return name;
+}
+
+// ---------------- Tests ----------------
+
+bool test_defaults_match_plain_session_options() {
+    SessionConfig cfg;
+    return cfg.intra_op_threads == 0 && cfg.inter_op_threads == 0 &&
+           cfg.execution_mode == ORT_SEQUENTIAL && cfg.graph_optimization == ORT_ENABLE_ALL &&
+           cfg.mem_pattern && cfg.cpu_arena && cfg.allow_spinning;
+}
+
+bool test_set_parses_every_key() {
+    SessionConfig cfg;
+    string err;
+    const bool ok = cfg.set("intra_op_threads", "2", err) && cfg.set("inter_op_threads", "3", err) &&
+                    cfg.set("execution_mode", "parallel", err) && cfg.set("graph_optimization", "basic", err) &&
+                    cfg.set("mem_pattern", "false", err) && cfg.set("cpu_arena", "0", err) &&
+                    cfg.set("allow_spinning", "off", err) && cfg.set("optimized_model_dir", "/var/cache/yolo", err) &&
+                    cfg.set("mmap_model", "true", err) && cfg.set("warmup_runs", "3", err) &&
+                    cfg.set("warmup_batch", "4", err);
+    if (!ok) { LOG("set failed: " << err); return false; }
+    return cfg.intra_op_threads == 2 && cfg.inter_op_threads == 3 &&
+           cfg.execution_mode == ORT_PARALLEL && cfg.graph_optimization == ORT_ENABLE_BASIC &&
+           !cfg.mem_pattern && !cfg.cpu_arena && !cfg.allow_spinning &&
+           cfg.optimized_model_dir == "/var/cache/yolo" && cfg.mmap_model &&
+           cfg.warmup_runs == 3 && cfg.warmup_batch == 4;
+}
+
+bool test_set_rejects_bad_input() {
+    SessionConfig cfg;
+    string err;
+    if (cfg.set("intra_threads", "2", err)) { LOG("unknown key accepted"); return false; }
+    if (err.find("intra_threads") == string::npos) { LOG("error does not name the key: " << err); return false; }
+    if (cfg.set("intra_op_threads", "-1", err)) { LOG("negative thread count accepted"); return false; }
+    if (cfg.set("intra_op_threads", "4x", err)) { LOG("trailing junk accepted"); return false; }
+    if (cfg.set("execution_mode", "async", err)) { LOG("unknown execution mode accepted"); return false; }
+    if (cfg.set("mem_pattern", "maybe", err)) { LOG("non-boolean accepted"); return false; }
+    if (cfg.set("warmup_batch", "0", err)) { LOG("zero warm-up batch accepted"); return false; }
+    return cfg.intra_op_threads == 0 && cfg.warmup_batch == 1;
+}
+
+bool test_load_file_with_comments() {
+    const string path = writeTemp("test_session.conf",
+        "# per-worker caps\n"
+        "intra_op_threads = 1\n"
+        "\n"
+        "  graph_optimization=extended   # trailing comment\n"
+        "allow_spinning = false\r\n");
+    SessionConfig cfg;
+    string err;
+    const bool ok = cfg.loadFile(path, err);
+    remove(path.c_str());
+    if (!ok) { LOG("loadFile failed: " << err); return false; }
+    return cfg.intra_op_threads == 1 && cfg.graph_optimization == ORT_ENABLE_EXTENDED &&
+           !cfg.allow_spinning && cfg.cpu_arena;
+}
+
+bool test_load_file_reports_line() {
+    const string path = writeTemp("test_session_bad.conf", "intra_op_threads = 1\nexecution_mode parallel\n");
+    SessionConfig cfg;
+    string err;
+    const bool ok = cfg.loadFile(path, err);
+    remove(path.c_str());
+    if (ok) { LOG("malformed line accepted"); return false; }
+    if (err.find(":2:") == string::npos) { LOG("error does not point at line 2: " << err); return false; }
+
+    SessionConfig missing;
+    return !missing.loadFile("no_such_session.conf", err);
+}
+
+bool test_apply_accepts_all_settings() {
+    SessionConfig cfg;
+    string err;
+    cfg.set("intra_op_threads", "1", err);
+    cfg.set("inter_op_threads", "1", err);
+    cfg.set("execution_mode", "parallel", err);
+    cfg.set("mem_pattern", "false", err);
+    cfg.set("cpu_arena", "false", err);
+    cfg.set("allow_spinning", "false", err);
+    try {
+        Ort::SessionOptions options;
+        cfg.apply(options);
+    } catch (const Ort::Exception& e) {
+        LOG("apply threw: " << e.what());
+        return false;
+    }
+    return cfg.describe().find("intra_op_threads=1") != string::npos;
+}
+
+int main() {
+    int passed = 0, total = 0;
+    RUN_TEST(test_defaults_match_plain_session_options);
+    RUN_TEST(test_set_parses_every_key);
+    RUN_TEST(test_set_rejects_bad_input);
+    RUN_TEST(test_load_file_with_comments);
+    RUN_TEST(test_load_file_reports_line);
+    RUN_TEST(test_apply_accepts_all_settings);
+
+    cout << "----------------------------------------\n";
+    cout << "Test summary: Passed " << passed << " / " << total << " tests\n";
+    return (passed == total) ? 0 : 1;
+}